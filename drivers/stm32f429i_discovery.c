@@ -139,6 +139,7 @@ static void               SPIx_Init(void);
 static void               SPIx_Write(uint16_t Value);
 static uint32_t           SPIx_Read(uint8_t ReadSize);
 static uint8_t            SPIx_WriteRead(uint8_t Byte);
+static void               SPIx_ReadBuffer(uint8_t *pBuffer, uint16_t Size);
 static void               SPIx_Error(void);
 static void               SPIx_MspInit(SPI_HandleTypeDef *hspi);
 
@@ -747,6 +748,25 @@ static uint8_t SPIx_WriteRead(uint8_t Byte)
   return receivedbyte;
 }
 
+/**
+  * @brief  Reads a block of bytes from the SPI bus in a single transfer.
+  *         The buffer contents are clocked out while it is filled, so the
+  *         caller sets it to dummy bytes first.
+  * @note   The transfer is blocking: GYRO_IO_Read() returns the data to its
+  *         caller, and this BSP enables no SPI interrupt or DMA stream for
+  *         the bus. The asynchronous bursts are done by the Gyro class of
+  *         the firmware through mbed instead.
+  * @param  pBuffer: Pointer to the buffer that receives the data
+  * @param  Size: Number of bytes to read
+  */
+static void SPIx_ReadBuffer(uint8_t *pBuffer, uint16_t Size)
+{
+  if(HAL_SPI_TransmitReceive(&SpiHandle, pBuffer, pBuffer, Size, SpixTimeout) != HAL_OK)
+  {
+    SPIx_Error();
+  }
+}
+
 /**
   * @brief  SPIx error treatment function.
   */
@@ -1052,6 +1072,8 @@ void GYRO_IO_Write(uint8_t* pBuffer, uint8_t WriteAddr, uint16_t NumByteToWrite)
   */
 void GYRO_IO_Read(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
 {  
+  uint16_t i;
+  
   if(NumByteToRead > 0x01)
   {
     ReadAddr |= (uint8_t)(READWRITE_CMD | MULTIPLEBYTE_CMD);
@@ -1066,15 +1088,15 @@ void GYRO_IO_Read(uint8_t* pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead)
   /* Send the Address of the indexed register */
   SPIx_WriteRead(ReadAddr);
   
-  /* Receive the data that will be read from the device (MSB First) */
-  while(NumByteToRead > 0x00)
+  /* Send dummy bytes (0x00) to generate the SPI clock to Gyroscope (Slave device) */
+  for(i = 0; i < NumByteToRead; i++)
   {
-    /* Send dummy byte (0x00) to generate the SPI clock to Gyroscope (Slave device) */
-    *pBuffer = SPIx_WriteRead(DUMMY_BYTE);
-    NumByteToRead--;
-    pBuffer++;
+    pBuffer[i] = DUMMY_BYTE;
   }
   
+  /* Receive the data that will be read from the device (MSB First) in one transfer */
+  SPIx_ReadBuffer(pBuffer, NumByteToRead);
+  
   /* Set chip select High at the end of the transmission */ 
   GYRO_CS_HIGH();
 }  
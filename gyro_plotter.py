@@ -20,6 +20,9 @@ xPos = 'center'
 allow_change_x = True
 zPos = 'center'
 allow_change_z = True
+firstDeviceTime = None
+lastDeviceTime = None
+lastSequence = None
 
 def saveData(save):
     fileName = 'data.txt'
@@ -29,17 +32,27 @@ def saveData(save):
     f.close()
 
 def get_data(data):
-    data = str(data)
+    # parses 'x: X y: Y z: Z t: T n: N' lines, t is the device time in microseconds
+    # and n the sample sequence number; older firmware only sends x, y and z
     try:
-        if data[2] == 'x':
-            data = data.split(' ')
-            x = int(data[1])
-            y = int(data[3])
-            z = int(data[5][:-5])
-            return x, y, z
+        fields = data.decode().split()
+        values = dict(zip(fields[0::2], fields[1::2]))
+        x = int(values['x:'])
+        y = int(values['y:'])
+        z = int(values['z:'])
+        t = int(values['t:']) if 't:' in values else None
+        n = int(values['n:']) if 'n:' in values else None
+        return x, y, z, t, n
     except:
         pass
-    return None, None, None
+    return None, None, None, None, None
+
+def unwrap_time(t, last):
+    # the device timer is 32 bits of microseconds, it wraps every ~71 minutes
+    if last is not None:
+        while t < last:
+            t += 1 << 32
+    return t
 
 def determinePos(data, pastPos, allow_change=True, change_trigger=30000, reset_trigger=5000):
     newPos = pastPos
@@ -69,10 +82,23 @@ def animate_x(i, startTime, t, x, y, z):
     global allow_change_x
     global zPos
     global allow_change_z
+    global firstDeviceTime
+    global lastDeviceTime
+    global lastSequence
     for i in range(5):
         data = ser.readline()
-        x_data, y_data, z_data = get_data(data)
-        Time = time.time() - startTime
+        x_data, y_data, z_data, t_data, n_data = get_data(data)
+        if n_data is not None and n_data == lastSequence:
+            continue # same sample sent twice
+        lastSequence = n_data
+        if t_data is not None:
+            # stamp with the time the device took the sample, not the serial arrival time
+            lastDeviceTime = unwrap_time(t_data, lastDeviceTime)
+            if firstDeviceTime is None:
+                firstDeviceTime = lastDeviceTime
+            Time = (lastDeviceTime - firstDeviceTime) / 1e6
+        else:
+            Time = time.time() - startTime
         if x_data != None:
             t.append(Time)
             x.append(x_data)
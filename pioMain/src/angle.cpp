@@ -0,0 +1,116 @@
+#include "angle.h"
+
+// Q8 rate times microseconds times hundredths of mdps per digit, over this, is Q16 degrees:
+// 2^16 / (2 * 2^8 * 100 * 1000 * 1000000) = 128 / 10^11
+#define angle_divisor 100000000000LL
+#define angle_multiplier 128
+
+// Angle constructor, starts at the sensitivity of the 245dps full scale
+Angle::Angle::Angle(){
+    sensitivity = 875;
+    setBias(0, 0, 0);
+    reset();
+}
+
+// Angle public methods
+void Angle::Angle::reset(){
+    /*
+    Method used to start integrating from zero on every axis.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    for(int axis = 0; axis < 3; axis++){
+        angle[axis] = 0;
+        level[axis] = 0;
+        carry[axis] = 0;
+        previous[axis] = 0;
+    }
+    lastTime = 0;
+    started = false;
+}
+
+void Angle::Angle::setBias(short int biasX, short int biasY, short int biasZ){
+    /*
+    Method used to set the bias left in the samples after the gyro bias.
+
+    Parameters:
+        biasX, biasY, biasZ: bias of each axis in Q8 raw units
+    Returns:
+        None
+    */
+    bias[0] = biasX;
+    bias[1] = biasY;
+    bias[2] = biasZ;
+}
+
+void Angle::Angle::add(const Gyro::Sample &sample){
+    /*
+    Method used to integrate the rate from the previous sample to this one,
+    the average of both rates times the time between them. The first sample
+    after reset() only sets the starting rate. Gaps longer than
+    angle_max_gap are integrated as angle_max_gap.
+
+    Parameters:
+        sample: the next sample
+    Returns:
+        None
+    */
+    const short int values[3] = {sample.x, sample.y, sample.z};
+    int rate[3];
+    for(int axis = 0; axis < 3; axis++){
+        rate[axis] = values[axis] * 256 - bias[axis];
+    }
+    if(started){
+        unsigned int gap = sample.time - lastTime;
+        if(gap > angle_max_gap){
+            gap = angle_max_gap;
+        }
+        long long scale = (long long)gap * sensitivity * angle_multiplier;
+        for(int axis = 0; axis < 3; axis++){
+            long long total = (long long)(previous[axis] + rate[axis]) * scale + carry[axis];
+            angle[axis] += (int)(total / angle_divisor);
+            carry[axis] = total % angle_divisor;
+        }
+    }
+    for(int axis = 0; axis < 3; axis++){
+        previous[axis] = rate[axis];
+    }
+    lastTime = sample.time;
+    started = true;
+}
+
+bool Angle::Angle::step(char *x, char *y, char *z){
+    /*
+    Method used to take the next step the angle went through. An axis that
+    turned several steps since the last call gives one per call, the axes
+    are checked in x, y, z order.
+
+    Parameters:
+        x, y, z: pointers to the step of each axis, 1 positive, 2 negative, 0 none
+    Returns:
+        true if a step was taken, false if no axis reached the next step
+    */
+    const int size = angle_step << angle_fraction_bits;
+    char *steps[3] = {x, y, z};
+    for(int axis = 0; axis < 3; axis++){
+        int direction = 0;
+        if(angle[axis] - level[axis] >= size){
+            level[axis] += size;
+            direction = 1;
+        }
+        else if(angle[axis] - level[axis] <= -size){
+            level[axis] -= size;
+            direction = 2;
+        }
+        if(direction != 0){
+            for(int other = 0; other < 3; other++){
+                *steps[other] = (other == axis) ? direction : 0;
+            }
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,61 @@
+/*
+Angle Class
+
+This class integrates the angular rate of each axis into the angle the
+device turned through since the recording started, in Q16 degrees. The
+rate is integrated with the trapezoidal rule over the real time between
+samples, in integer math: the part of each step too small for the angle is
+carried to the next one, so rounding never adds up to a drift.
+
+The gyro removes a whole number of raw units of bias from every sample. The
+fraction of a raw unit left over can be given in Q8 and is removed here
+before integrating, since integrated for seconds it would add up to a
+noticeable angle.
+
+The angle is quantized into steps of angle_step degrees. Every time an axis
+turns one more step away from the last step it reached, a step is given:
+that axis 1 when it turned positive, 2 when it turned negative, and the
+other axes 0, the same format as a move. A sequence of steps only depends on
+how far the device was turned and in which order, not on how fast.
+
+*/
+
+// safeguards
+#ifndef angle_h
+#define angle_h
+
+#include "gyro.h"
+
+// angle values
+#define angle_fraction_bits 16 // Q16 degrees
+#define angle_step 30 // degrees per step
+#define angle_max_gap 100000 // microseconds, longest time between samples integrated
+
+namespace Angle{
+
+    class Angle{
+        public:
+            // constructor
+            Angle();
+            // public methods
+            void reset();
+            void setSensitivity(unsigned short int sensitivity){this->sensitivity = sensitivity;}
+            void setBias(short int biasX, short int biasY, short int biasZ);
+            void add(const Gyro::Sample &sample);
+            bool step(char *x, char *y, char *z);
+            int getX(){return angle[0];}
+            int getY(){return angle[1];}
+            int getZ(){return angle[2];}
+        private:
+            unsigned short int sensitivity; // hundredths of millidegrees per second per digit
+            short int bias[3]; // Q8 raw units left after the gyro bias
+            int angle[3]; // Q16 degrees
+            int level[3]; // Q16 degrees of the last step reached
+            long long carry[3]; // part of the angle below one Q16 unit, over the divisor
+            int previous[3]; // Q8 rate of the previous sample
+            unsigned int lastTime;
+            bool started;
+    };
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "bias.h"
+
+// Bias constructor, sets the window length
+Bias::Bias::Bias(int windowShift){
+    shift = windowShift;
+    still = false;
+    for(int axis = 0; axis < 3; axis++){
+        mean[axis] = 0;
+        fraction[axis] = 0;
+    }
+    setStillThreshold(0);
+    reset();
+}
+
+// Bias public methods
+void Bias::Bias::reset(){
+    /*
+    Method used to start a new window.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    count = 0;
+    for(int axis = 0; axis < 3; axis++){
+        sum[axis] = 0;
+        sumSquares[axis] = 0;
+    }
+}
+
+void Bias::Bias::setStillThreshold(short int threshold){
+    /*
+    Method used to set how much an axis may move while still counting as still,
+    in raw units of the active full scale.
+
+    Parameters:
+        threshold: largest standard deviation and mean of a still axis
+    Returns:
+        None
+    */
+    stillThreshold = threshold;
+    stillVariance = (long long)threshold * threshold;
+}
+
+bool Bias::Bias::add(const Gyro::Sample &sample){
+    /*
+    Method used to add one sample to the running sums.
+    When the window is full the mean and stillness are updated and a new
+    window is started.
+
+    Parameters:
+        sample: the sample to add
+    Returns:
+        true if the sample completed a window, false otherwise
+    */
+    accumulate(0, sample.x);
+    accumulate(1, sample.y);
+    accumulate(2, sample.z);
+    count++;
+    if(count < (1 << shift)){
+        return false;
+    }
+
+    still = true;
+    for(int axis = 0; axis < 3; axis++){
+        if(!finish(axis)){
+            still = false;
+        }
+    }
+    reset();
+    return true;
+}
+
+void Bias::Bias::accumulate(int axis, short int value){
+    /*
+    Method used to add one value to the sums of an axis.
+
+    Parameters:
+        axis: 0 for x, 1 for y, 2 for z
+        value: the value to add
+    Returns:
+        None
+    */
+    sum[axis] += value;
+    sumSquares[axis] += (int)value * value;
+}
+
+bool Bias::Bias::finish(int axis){
+    /*
+    Method used to find the mean and variance of an axis at the end of a window.
+
+    Parameters:
+        axis: 0 for x, 1 for y, 2 for z
+    Returns:
+        true if the axis was still, false otherwise
+    */
+    int average = sum[axis] >> shift;
+    long long variance = (sumSquares[axis] >> shift) - (long long)average * average;
+    int remainder = sum[axis] - average * (1 << shift);
+    mean[axis] = (short int)average;
+    fraction[axis] = (short int)((shift >= 8) ? remainder >> (shift - 8) : remainder << (8 - shift));
+    return variance <= stillVariance;
+}
@@ -0,0 +1,58 @@
+/*
+Bias Class
+
+This class keeps running statistics of gyro samples over a fixed window to
+estimate the zero rate bias of each axis. The window length is a power of two
+so the mean and variance are found with shifts, all in integer math.
+
+At the end of each window it reports whether the device was still, meaning
+the spread of every axis stayed below the still threshold, and the mean of
+every axis over the window, as a whole number of raw units rounded down and
+the Q8 fraction of a raw unit above it. The gyro uses it to calibrate at startup and to
+keep correcting its bias whenever the device sits still.
+
+*/
+
+// safeguards
+#ifndef bias_h
+#define bias_h
+
+#include "gyro.h"
+
+// bias values
+#define bias_window_shift 8 // 256 samples per window, 320ms at 800Hz
+#define still_rate_mdps 2000 // largest spread of a still axis in millidegrees per second
+
+namespace Bias{
+
+    class Bias{
+        public:
+            // constructor
+            Bias(int windowShift);
+            // public methods
+            void reset();
+            bool add(const Gyro::Sample &sample);
+            void setStillThreshold(short int threshold);
+            bool isStill(){return still;}
+            short int getX(){return mean[0];}
+            short int getY(){return mean[1];}
+            short int getZ(){return mean[2];}
+            short int getFractionX(){return fraction[0];}
+            short int getFractionY(){return fraction[1];}
+            short int getFractionZ(){return fraction[2];}
+        private:
+            int shift;
+            int count;
+            int sum[3];
+            long long sumSquares[3];
+            long long stillVariance;
+            short int stillThreshold;
+            short int mean[3];
+            short int fraction[3]; // Q8 part of the mean below the whole mean
+            bool still;
+            void accumulate(int axis, short int value);
+            bool finish(int axis);
+    };
+}
+
+#endif
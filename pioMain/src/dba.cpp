@@ -0,0 +1,194 @@
+#include "dba.h"
+#include "dtw.h"
+#include <climits>
+
+// steps into a cell of the alignment
+#define step_match 0
+#define step_average 1 // the template advances alone
+#define step_recording 2 // the recording advances alone
+
+// Dba constructor
+Dba::Dba::Dba(){
+}
+
+// Dba public methods
+int Dba::Dba::average(const Trace::Trace *recordings, int count, Trace::Trace *average, Trace::Trace *tolerance){
+    /*
+    Method used to merge the recordings of a key into one template. The
+    template starts as the recording closest to all the others, then each
+    round aligns every recording to it and replaces each template point with
+    the mean of the points aligned to it. The last round also gives the
+    tolerance of each template point.
+
+    Parameters:
+        recordings: array of recorded traces
+        count: number of recordings
+        average: trace that will store the template
+        tolerance: trace that will store the tolerance of each template point
+    Returns:
+        number of recordings merged into the template
+    */
+    int merged = 0;
+    average->clear();
+    tolerance->clear();
+    if(count <= 0){
+        return 0;
+    }
+
+    const Trace::Trace &start = recordings[medoid(recordings, count)];
+    for(int i = 0; i < start.getSize(); i++){
+        average->append(start[i]);
+    }
+    int n = average->getSize();
+
+    for(int round = 0; round < dba_iterations; round++){
+        for(int i = 0; i < n; i++){
+            this->count[i] = 0;
+            for(int axis = 0; axis < 3; axis++){
+                sum[i][axis] = 0;
+                sumSquares[i][axis] = 0;
+            }
+        }
+
+        merged = 0;
+        for(int r = 0; r < count; r++){
+            if(align(recordings[r], *average, true) != dtw_no_match){
+                merged++;
+            }
+        }
+
+        //every template point has at least one point aligned to it, the path crosses every row
+        average->clear();
+        tolerance->clear();
+        for(int i = 0; i < n; i++){
+            Trace::Point mean;
+            Trace::Point spread;
+            short int *meanAxes[3] = {&mean.x, &mean.y, &mean.z};
+            short int *spreadAxes[3] = {&spread.x, &spread.y, &spread.z};
+            for(int axis = 0; axis < 3; axis++){
+                int m = sum[i][axis] / this->count[i];
+                long long variance = sumSquares[i][axis] / this->count[i] - (long long)m * m;
+                //integer square root of the variance
+                long long root = 0;
+                for(long long bit = 1LL << 30; bit > 0; bit >>= 1){
+                    if((root + bit) * (root + bit) <= variance){
+                        root += bit;
+                    }
+                }
+                *meanAxes[axis] = (short int)m;
+                *spreadAxes[axis] = (root > SHRT_MAX) ? SHRT_MAX : (short int)root;
+            }
+            average->append(mean);
+            tolerance->append(spread);
+        }
+    }
+    return merged;
+}
+
+// Dba private methods
+unsigned int Dba::Dba::align(const Trace::Trace &recording, const Trace::Trace &average, bool accumulate){
+    /*
+    Method used to align a recording to the template with dynamic time
+    warping. The step into every cell within the band is kept, so the best
+    path can be followed back from the last cell. Along the path, each
+    recording point is added to the sums of the template point it matches.
+
+    Parameters:
+        recording: the recording to align
+        average: the template
+        accumulate: true to add the aligned points to the sums
+    Returns:
+        the path cost, dtw_no_match if a trace is empty or the lengths differ by more than the band
+    */
+    int n = average.getSize();
+    int m = recording.getSize();
+    int difference = (n > m) ? n - m : m - n;
+    if((n == 0) || (m == 0) || (difference > dba_band)){
+        return dtw_no_match;
+    }
+
+    int *previous = rows[0];
+    int *current = rows[1];
+    previous[0] = 0;
+    for(int j = 1; j <= m; j++){
+        previous[j] = dtw_infinity;
+    }
+
+    for(int i = 1; i <= n; i++){
+        int low = (i - dba_band > 1) ? i - dba_band : 1;
+        int high = (i + dba_band < m) ? i + dba_band : m;
+        current[low - 1] = dtw_infinity;
+        const Trace::Point &point = average[i - 1];
+        for(int j = low; j <= high; j++){
+            int best = previous[j - 1];
+            char step = step_match;
+            if(previous[j] < best){
+                best = previous[j];
+                step = step_average;
+            }
+            if(current[j - 1] < best){
+                best = current[j - 1];
+                step = step_recording;
+            }
+            current[j] = best + Dtw::pointCost(point, recording[j - 1]);
+            steps[i - 1][j - i + dba_band] = step;
+        }
+        if(high < m){
+            current[high + 1] = dtw_infinity;
+        }
+        int *swap = previous;
+        previous = current;
+        current = swap;
+    }
+
+    if(accumulate){
+        int i = n;
+        int j = m;
+        while((i > 0) && (j > 0)){
+            const Trace::Point &point = recording[j - 1];
+            sum[i - 1][0] += point.x;
+            sum[i - 1][1] += point.y;
+            sum[i - 1][2] += point.z;
+            sumSquares[i - 1][0] += (long long)point.x * point.x;
+            sumSquares[i - 1][1] += (long long)point.y * point.y;
+            sumSquares[i - 1][2] += (long long)point.z * point.z;
+            count[i - 1]++;
+            char step = steps[i - 1][j - i + dba_band];
+            if(step != step_recording){
+                i--;
+            }
+            if(step != step_average){
+                j--;
+            }
+        }
+    }
+    return (unsigned int)previous[m];
+}
+
+int Dba::Dba::medoid(const Trace::Trace *recordings, int count){
+    /*
+    Method used to find the recording with the lowest total alignment cost
+    to all the others, the starting template.
+
+    Parameters:
+        recordings: array of recorded traces
+        count: number of recordings
+    Returns:
+        index of the medoid recording
+    */
+    int best = 0;
+    unsigned long long bestCost = ~0ULL;
+    for(int a = 0; a < count; a++){
+        unsigned long long cost = 0;
+        for(int b = 0; b < count; b++){
+            if(a != b){
+                cost += align(recordings[b], recordings[a], false);
+            }
+        }
+        if((recordings[a].getSize() > 0) && (cost < bestCost)){
+            bestCost = cost;
+            best = a;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,52 @@
+/*
+Dba Class
+
+This class merges several recordings of the key into one template with DTW
+barycenter averaging. Each recording is aligned to the current template with
+dynamic time warping and every template point becomes the mean of all the
+recording points aligned to it. A few rounds of this move the template to
+the centre of the recordings, whatever their timing.
+
+The spread of the points aligned to each template point gives a per axis
+tolerance, one standard deviation, so the matcher can forgive the parts of
+the key the user never repeats exactly.
+
+The alignment keeps the step taken into every cell of the band, so the band
+is fixed at dba_band and recordings whose length differs from the template
+by more than it are left out. The work is bounded by
+dba_iterations * recordings * points * band.
+
+*/
+
+// safeguards
+#ifndef dba_h
+#define dba_h
+
+#include "trace.h"
+
+// dba values
+#define dba_band 25 // band half width in points used for the alignments
+#define dba_iterations 3 // rounds of alignment and averaging
+
+namespace Dba{
+
+    class Dba{
+        public:
+            // constructor
+            Dba();
+            // public methods
+            int average(const Trace::Trace *recordings, int count, Trace::Trace *average, Trace::Trace *tolerance);
+        private:
+            // private methods
+            unsigned int align(const Trace::Trace &recording, const Trace::Trace &average, bool accumulate);
+            int medoid(const Trace::Trace *recordings, int count);
+            // private variables
+            int rows[2][trace_length + 1];
+            char steps[trace_length][2 * dba_band + 1]; // step into each cell, indexed by the offset from the diagonal
+            int sum[trace_length][3];
+            long long sumSquares[trace_length][3];
+            int count[trace_length];
+    };
+}
+
+#endif
@@ -94,6 +94,14 @@ GYRO_DrvTypeDef L3gd20Drv =
   L3GD20_ReadXYZAngRate
 };
 
+/* CTRL_REG4 settings used by the fixed point path, so it never reads them back */
+static uint8_t L3GD20_CachedBigEndian = 0;
+static int32_t L3GD20_CachedSensitivity = L3GD20_SENSITIVITY_250DPS_Q2;
+static uint8_t L3GD20_CacheValid = 0;
+
+/* Raw bytes of a full FIFO for the batch read */
+static uint8_t L3GD20_BatchBuffer[L3GD20_FIFO_DEPTH * 6];
+
 /**
   * @}
   */
@@ -101,6 +109,7 @@ GYRO_DrvTypeDef L3gd20Drv =
 /** @defgroup L3GD20_Private_FunctionPrototypes
   * @{
   */
+static void L3GD20_UpdateCache(uint8_t Ctrl4);
 
 /**
   * @}
@@ -130,6 +139,9 @@ void L3GD20_Init(uint16_t InitStruct)
   /* Write value to MEMS CTRL_REG4 register */  
   ctrl = (uint8_t) (InitStruct >> 8);
   GYRO_IO_Write(&ctrl, L3GD20_CTRL_REG4_ADDR, 1);
+  
+  /* Keep the fixed point path in step with the new full scale and endianness */
+  L3GD20_UpdateCache(ctrl);
 }
 
 
@@ -397,6 +409,114 @@ void L3GD20_ReadXYZAngRate(float *pfData)
   }
 }
 
+/**
+  * @brief  Stores the endianness and sensitivity set in CTRL_REG4.
+  * @param  Ctrl4: value of CTRL_REG4
+  * @retval None
+  */
+static void L3GD20_UpdateCache(uint8_t Ctrl4)
+{
+  L3GD20_CachedBigEndian = (Ctrl4 & L3GD20_BLE_MSB) ? 1 : 0;
+  
+  switch(Ctrl4 & L3GD20_FULLSCALE_SELECTION)
+  {
+  case L3GD20_FULLSCALE_250:
+    L3GD20_CachedSensitivity = L3GD20_SENSITIVITY_250DPS_Q2;
+    break;
+    
+  case L3GD20_FULLSCALE_500:
+    L3GD20_CachedSensitivity = L3GD20_SENSITIVITY_500DPS_Q2;
+    break;
+    
+  default:
+    L3GD20_CachedSensitivity = L3GD20_SENSITIVITY_2000DPS_Q2;
+    break;
+  }
+  L3GD20_CacheValid = 1;
+}
+
+/**
+  * @brief  Reads CTRL_REG4 once and caches the settings the fixed point path needs.
+  *         L3GD20_Init() keeps the cache up to date, call this only if CTRL_REG4
+  *         was written some other way.
+  * @param  None
+  * @retval None
+  */
+void L3GD20_CacheConfig(void)
+{
+  uint8_t tmpreg = 0;
+  
+  GYRO_IO_Read(&tmpreg, L3GD20_CTRL_REG4_ADDR, 1);
+  L3GD20_UpdateCache(tmpreg);
+}
+
+/**
+  * @brief  Converts raw output register samples to angular rates.
+  *         Each sample is 6 bytes in OUT_X_L to OUT_Z_H order, as read from the
+  *         output registers or drained from the FIFO. The sensitivities are exact
+  *         in Q2, so each axis costs one multiply and the rate is never rounded.
+  * @param  pBuffer: raw samples
+  * @param  pData: 3 rates per sample in Q2 millidegrees per second
+  * @param  NumSamples: number of samples to convert
+  * @retval None
+  */
+void L3GD20_ConvertAngRateBatch(const uint8_t *pBuffer, int32_t *pData, uint16_t NumSamples)
+{
+  int32_t sensitivity;
+  int16_t raw;
+  uint16_t i;
+  
+  if(!L3GD20_CacheValid)
+  {
+    L3GD20_CacheConfig();
+  }
+  sensitivity = L3GD20_CachedSensitivity;
+  
+  for(i = 0; i < NumSamples * 3; i++)
+  {
+    if(!L3GD20_CachedBigEndian)
+    {
+      raw = (int16_t)(((uint16_t)pBuffer[2*i+1] << 8) + pBuffer[2*i]);
+    }
+    else
+    {
+      raw = (int16_t)(((uint16_t)pBuffer[2*i] << 8) + pBuffer[2*i+1]);
+    }
+    pData[i] = raw * sensitivity;
+  }
+}
+
+/**
+  * @brief  Reads the L3GD20 angular rates without reading CTRL_REG4 or using floats.
+  * @param  pData: 3 rates in Q2 millidegrees per second
+  * @retval None
+  */
+void L3GD20_ReadXYZAngRateFixed(int32_t *pData)
+{
+  uint8_t tmpbuffer[6] = {0};
+  
+  GYRO_IO_Read(tmpbuffer, L3GD20_OUT_X_L_ADDR, 6);
+  L3GD20_ConvertAngRateBatch(tmpbuffer, pData, 1);
+}
+
+/**
+  * @brief  Reads several samples from the FIFO in one burst and converts them.
+  *         With the FIFO enabled the register address wraps from OUT_Z_H back
+  *         to OUT_X_L, so consecutive samples come out of a single read.
+  * @param  pData: 3 rates per sample in Q2 millidegrees per second, oldest first
+  * @param  NumSamples: number of samples to read, at most L3GD20_FIFO_DEPTH
+  * @retval None
+  */
+void L3GD20_ReadXYZAngRateBatch(int32_t *pData, uint8_t NumSamples)
+{
+  if(NumSamples > L3GD20_FIFO_DEPTH)
+  {
+    NumSamples = L3GD20_FIFO_DEPTH;
+  }
+  GYRO_IO_Read(L3GD20_BatchBuffer, L3GD20_OUT_X_L_ADDR, NumSamples * 6);
+  L3GD20_ConvertAngRateBatch(L3GD20_BatchBuffer, pData, NumSamples);
+}
+
 /**
   * @}
   */ 
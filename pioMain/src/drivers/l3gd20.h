@@ -161,6 +161,10 @@
 #define L3GD20_SENSITIVITY_250DPS  ((float)8.75f)         /*!< gyroscope sensitivity with 250 dps full scale [DPS/LSB]  */
 #define L3GD20_SENSITIVITY_500DPS  ((float)17.50f)        /*!< gyroscope sensitivity with 500 dps full scale [DPS/LSB]  */
 #define L3GD20_SENSITIVITY_2000DPS ((float)70.00f)        /*!< gyroscope sensitivity with 2000 dps full scale [DPS/LSB] */
+#define L3GD20_RATE_FRACTION_BITS     2                   /*!< fixed point rates are Q2 mdps, every sensitivity is exact in it and 2000 dps fits 32 bits */
+#define L3GD20_SENSITIVITY_250DPS_Q2  ((int32_t)35)       /*!< 8.75 mdps/LSB with 2 fractional bits, exact  */
+#define L3GD20_SENSITIVITY_500DPS_Q2  ((int32_t)70)       /*!< 17.50 mdps/LSB with 2 fractional bits, exact */
+#define L3GD20_SENSITIVITY_2000DPS_Q2 ((int32_t)280)      /*!< 70.00 mdps/LSB with 2 fractional bits, exact */
 /**
   * @}
   */
@@ -262,6 +266,8 @@
 #define L3GD20_HPFCF_7              0x07
 #define L3GD20_HPFCF_8              0x08
 #define L3GD20_HPFCF_9              0x09
+
+#define L3GD20_FIFO_DEPTH           32   /* samples held by the FIFO */
 /**
   * @}
   */
@@ -290,6 +296,12 @@ void    L3GD20_FilterCmd(uint8_t HighPassFilterState);
 void    L3GD20_ReadXYZAngRate(float *pfData);
 uint8_t L3GD20_GetDataStatus(void);
 
+/* Fixed point angular rate functions, results in Q2 millidegrees per second */
+void    L3GD20_CacheConfig(void);
+void    L3GD20_ReadXYZAngRateFixed(int32_t *pData);
+void    L3GD20_ReadXYZAngRateBatch(int32_t *pData, uint8_t NumSamples);
+void    L3GD20_ConvertAngRateBatch(const uint8_t *pBuffer, int32_t *pData, uint16_t NumSamples);
+
 /* Gyroscope IO functions */
 void    GYRO_IO_Init(void);
 void    GYRO_IO_DeInit(void);
@@ -0,0 +1,435 @@
+#include "dsp.h"
+#include <cmath>
+
+// Biquad constructor, passes the samples through until coefficients are set
+Dsp::Biquad::Biquad(){
+    const short int through[5] = {1 << biquad_shift, 0, 0, 0, 0};
+    setCoefficients(through);
+    reset();
+}
+
+// Biquad public methods
+void Dsp::Biquad::setCoefficients(const short int *coefficients){
+    /*
+    Method used to set the coefficients of the section, in Q14 so they can
+    reach 2. The output is
+        y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+    so the feedback coefficients are the negated ones of the usual form.
+
+    Parameters:
+        coefficients: array of b0, b1, b2, a1, a2
+    Returns:
+        None
+    */
+    b0b1 = pack(coefficients[0], coefficients[1]);
+    b2a1 = pack(coefficients[2], coefficients[3]);
+    a2 = coefficients[4];
+}
+
+void Dsp::Biquad::setLowpass(int rate, int cutoff){
+    /*
+    Method used to set the section to a second order Butterworth low pass.
+    The coefficients are found in floating point once and rounded to Q14.
+
+    Parameters:
+        rate: sample rate in Hz
+        cutoff: cutoff frequency in Hz, below half the rate
+    Returns:
+        None
+    */
+    float w = 2.0f * (float)M_PI * cutoff / rate;
+    float alpha = sinf(w) / (2.0f * 0.70710678f);
+    float a0 = 1.0f + alpha;
+    float scale = (float)(1 << biquad_shift) / a0;
+    short int coefficients[5] = {
+        saturate(lroundf((1.0f - cosf(w)) / 2.0f * scale)),
+        saturate(lroundf((1.0f - cosf(w)) * scale)),
+        saturate(lroundf((1.0f - cosf(w)) / 2.0f * scale)),
+        saturate(lroundf(2.0f * cosf(w) * scale)),
+        saturate(lroundf(-(1.0f - alpha) * scale)),
+    };
+    setCoefficients(coefficients);
+}
+
+void Dsp::Biquad::reset(){
+    /*
+    Method used to clear the past inputs and outputs.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    for(int axis = 0; axis < 3; axis++){
+        for(int i = 0; i < 4; i++){
+            state[axis][i] = 0;
+        }
+    }
+}
+
+void Dsp::Biquad::apply(Gyro::Sample *sample){
+    /*
+    Method used to filter a sample, each axis on its own. Two SMLALD and one
+    multiply per axis, the sum is shifted back to Q15 and saturated.
+
+    Parameters:
+        sample: pointer to the sample, filtered in place
+    Returns:
+        None
+    */
+    short int *values[3] = {&sample->x, &sample->y, &sample->z};
+    for(int axis = 0; axis < 3; axis++){
+        short int *past = state[axis];
+        short int input = *values[axis];
+        long long sum = smlald(pack(input, past[0]), b0b1, 0);
+        sum = smlald(pack(past[1], past[2]), b2a1, sum);
+        sum += (int)a2 * past[3];
+        short int output = saturate(sum >> biquad_shift);
+        past[1] = past[0];
+        past[0] = input;
+        past[3] = past[2];
+        past[2] = output;
+        *values[axis] = output;
+    }
+}
+
+// MovingAverage constructor, a shift of 0 passes the samples through
+Dsp::MovingAverage::MovingAverage(int shift){
+    setShift(shift);
+}
+
+// MovingAverage public methods
+void Dsp::MovingAverage::setShift(int shift){
+    /*
+    Method used to set the length of the window and empty it.
+
+    Parameters:
+        shift: the window is 1 << shift samples, from 0 to average_shift_max
+    Returns:
+        None
+    */
+    if(shift < 0){shift = 0;}
+    if(shift > average_shift_max){shift = average_shift_max;}
+    this->shift = shift;
+    reset();
+}
+
+void Dsp::MovingAverage::reset(){
+    /*
+    Method used to empty the window, it fills with zeros.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    index = 0;
+    sum[0] = 0;
+    sum[1] = 0;
+    for(int i = 0; i < (1 << average_shift_max); i++){
+        window[i][0] = 0;
+        window[i][1] = 0;
+    }
+}
+
+void Dsp::MovingAverage::apply(Gyro::Sample *sample){
+    /*
+    Method used to replace a sample by the average of the window ending at
+    it. Every sample is shifted down by the window length before it goes in,
+    so the sum of a window always fits a halfword and x and y are summed
+    together: the oldest pair leaves with QSUB16 and the new one comes in
+    with QADD16, and the sum is already the average. The saturation is never
+    reached, it only keeps a sum that went wrong from wrapping around.
+
+    Parameters:
+        sample: pointer to the sample, filtered in place
+    Returns:
+        None
+    */
+    int entering[2] = {
+        pack(sample->x >> shift, sample->y >> shift),
+        pack(sample->z >> shift, 0),
+    };
+    for(int i = 0; i < 2; i++){
+        sum[i] = qadd16(qsub16(sum[i], window[index][i]), entering[i]);
+        window[index][i] = entering[i];
+    }
+    index = (index + 1) & ((1 << shift) - 1);
+    sample->x = low(sum[0]);
+    sample->y = high(sum[0]);
+    sample->z = low(sum[1]);
+}
+
+// Median constructor
+Dsp::Median::Median(){
+    reset();
+}
+
+// Median public methods
+void Dsp::Median::reset(){
+    /*
+    Method used to forget the past samples, the next sample fills them.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    started = false;
+}
+
+void Dsp::Median::apply(Gyro::Sample *sample){
+    /*
+    Method used to replace a sample by the median of it and the 2 samples
+    before it, found with the minimum and maximum of x y pairs:
+        median = max(min(a, b), min(max(a, b), c))
+    A spike of one sample never gets through, the output lags by one sample.
+
+    Parameters:
+        sample: pointer to the sample, filtered in place
+    Returns:
+        None
+    */
+    int entering[2] = {pack(sample->x, sample->y), pack(sample->z, 0)};
+    if(!started){
+        for(int i = 0; i < 2; i++){
+            previous[0][i] = entering[i];
+            previous[1][i] = entering[i];
+        }
+        started = true;
+    }
+    int median[2];
+    for(int i = 0; i < 2; i++){
+        int a = previous[1][i];
+        int b = previous[0][i];
+        median[i] = max16(min16(a, b), min16(max16(a, b), entering[i]));
+        previous[1][i] = b;
+        previous[0][i] = entering[i];
+    }
+    sample->x = low(median[0]);
+    sample->y = high(median[0]);
+    sample->z = low(median[1]);
+}
+
+// Fir constructor, passes every sample through at a gain of one tap below 1 until taps are set
+Dsp::Fir::Fir(){
+    const short int through[2] = {SHRT_MAX, 0};
+    setTaps(through, 2, 1);
+}
+
+// Fir public methods
+bool Dsp::Fir::setTaps(const short int *taps, int count, int factor){
+    /*
+    Method used to set the taps of the filter, in Q15. An odd number of taps
+    gets a zero tap added so the taps go in pairs.
+
+    Parameters:
+        taps: array of the taps, the tap of the newest sample first
+        count: number of taps, up to fir_taps_max
+        factor: inputs per output
+    Returns:
+        true if the taps were set, false if there are too many
+    */
+    int even = (count + 1) & ~1;
+    if((count < 1) || (even > fir_taps_max) || (factor < 1)){
+        return false;
+    }
+    this->count = even;
+    this->factor = factor;
+    for(int k = 0; k < even; k++){
+        int tap = even - 1 - k;
+        this->taps[k] = (tap < count) ? taps[tap] : 0;
+    }
+    reset();
+    return true;
+}
+
+void Dsp::Fir::setLowpass(int count, int factor){
+    /*
+    Method used to set the filter to a Hamming windowed sinc low pass cut at
+    the new Nyquist frequency, so decimating by factor does not alias. The
+    taps are rounded to Q15 and the largest takes the rounding error so the
+    gain stays 1.
+
+    Parameters:
+        count: number of taps, up to fir_taps_max
+        factor: inputs per output
+    Returns:
+        None
+    */
+    if(count > fir_taps_max){count = fir_taps_max;}
+    if(count < 1){count = 1;}
+    if(factor < 1){factor = 1;}
+    float weights[fir_taps_max];
+    float total = 0.0f;
+    float middle = (count - 1) / 2.0f;
+    for(int k = 0; k < count; k++){
+        float t = (k - middle) / factor;
+        float sinc = (t == 0.0f) ? 1.0f : sinf((float)M_PI * t) / ((float)M_PI * t);
+        float window = (count > 1) ? 0.54f - 0.46f * cosf(2.0f * (float)M_PI * k / (count - 1)) : 1.0f;
+        weights[k] = sinc * window;
+        total += weights[k];
+    }
+    short int taps[fir_taps_max];
+    int sum = 0;
+    int largest = 0;
+    for(int k = 0; k < count; k++){
+        taps[k] = saturate(lroundf(weights[k] / total * SHRT_MAX));
+        sum += taps[k];
+        if(taps[k] > taps[largest]){largest = k;}
+    }
+    taps[largest] = saturate(taps[largest] + SHRT_MAX - sum);
+    setTaps(taps, count, factor);
+}
+
+void Dsp::Fir::reset(){
+    /*
+    Method used to clear the past samples.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    index = 0;
+    phase = 0;
+    for(int axis = 0; axis < 3; axis++){
+        for(int i = 0; i < 2 * fir_taps_max; i++){
+            history[axis][i] = 0;
+        }
+    }
+}
+
+bool Dsp::Fir::decimate(const Gyro::Sample &input, Gyro::Sample *output){
+    /*
+    Method used to take in a sample and, once every factor samples, give the
+    filtered sample. Only the kept outputs are computed. Each sample is
+    stored twice, count apart, so the window of the last count samples is
+    always in one piece and is read two samples at a time for SMLALD.
+
+    Parameters:
+        input: the next sample
+        output: pointer to the sample that will store the output, it keeps
+            the time and sequence number of the newest input
+    Returns:
+        true if an output was given
+    */
+    const short int values[3] = {input.x, input.y, input.z};
+    for(int axis = 0; axis < 3; axis++){
+        history[axis][index] = values[axis];
+        history[axis][index + count] = values[axis];
+    }
+    index = (index + 1 < count) ? index + 1 : 0;
+    if(++phase < factor){
+        return false;
+    }
+    phase = 0;
+
+    short int filtered[3];
+    for(int axis = 0; axis < 3; axis++){
+        const short int *window = &history[axis][index]; //oldest sample first
+        long long sum = 0;
+        for(int k = 0; k < count; k += 2){
+            sum = smlald(load(&window[k]), load(&taps[k]), sum);
+        }
+        filtered[axis] = saturate(sum >> fir_shift);
+    }
+    output->x = filtered[0];
+    output->y = filtered[1];
+    output->z = filtered[2];
+    output->time = input.time;
+    output->sequence = input.sequence;
+    return true;
+}
+
+// Cic constructor
+Dsp::Cic::Cic(int order, int shift){
+    if(!configure(order, shift)){
+        configure(1, 0);
+    }
+}
+
+// Cic public methods
+bool Dsp::Cic::configure(int order, int shift){
+    /*
+    Method used to set the stages and factor of the decimator. The sum grows
+    by shift bits per stage, so it must fit 32 bits with the 16 bit input.
+
+    Parameters:
+        order: integrator and comb stages, up to cic_order_max
+        shift: the decimation factor is 1 << shift
+    Returns:
+        true if the decimator was set, false if the sum would not fit
+    */
+    if((order < 1) || (order > cic_order_max) || (shift < 0) || (16 + order * shift > 32)){
+        return false;
+    }
+    this->order = order;
+    this->shift = shift;
+    reset();
+    return true;
+}
+
+void Dsp::Cic::reset(){
+    /*
+    Method used to clear the integrators and combs.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    phase = 0;
+    for(int axis = 0; axis < 3; axis++){
+        for(int stage = 0; stage < cic_order_max; stage++){
+            integrators[axis][stage] = 0;
+            combs[axis][stage] = 0;
+        }
+    }
+}
+
+bool Dsp::Cic::decimate(const Gyro::Sample &input, Gyro::Sample *output){
+    /*
+    Method used to take in a sample and, once every factor samples, give the
+    decimated sample. Every input goes through the integrators, only the
+    kept outputs go through the combs. The gain of the decimator is the
+    factor to the power of the order, a power of two, so it is removed with
+    a shift and the output stays in the range of the input.
+
+    Parameters:
+        input: the next sample
+        output: pointer to the sample that will store the output, it keeps
+            the time and sequence number of the newest input
+    Returns:
+        true if an output was given
+    */
+    const short int values[3] = {input.x, input.y, input.z};
+    for(int axis = 0; axis < 3; axis++){
+        unsigned int value = (unsigned int)(int)values[axis];
+        for(int stage = 0; stage < order; stage++){
+            integrators[axis][stage] += value;
+            value = integrators[axis][stage];
+        }
+    }
+    if(++phase < (1 << shift)){
+        return false;
+    }
+    phase = 0;
+
+    short int decimated[3];
+    for(int axis = 0; axis < 3; axis++){
+        unsigned int value = integrators[axis][order - 1];
+        for(int stage = 0; stage < order; stage++){
+            unsigned int previous = combs[axis][stage];
+            combs[axis][stage] = value;
+            value -= previous;
+        }
+        decimated[axis] = saturate((int)value >> (order * shift));
+    }
+    output->x = decimated[0];
+    output->y = decimated[1];
+    output->z = decimated[2];
+    output->time = input.time;
+    output->sequence = input.sequence;
+    return true;
+}
@@ -0,0 +1,170 @@
+/*
+Dsp Classes
+
+Small fixed point filters for the x, y, z samples of the gyro, all in Q15:
+    -Biquad: second order IIR section with Q14 coefficients
+    -MovingAverage: average of the last power of two samples
+    -Median: median of the last 3 samples, removes single sample spikes
+    -Fir: FIR filter that keeps one output every factor inputs
+    -Cic: cascaded integrator comb decimator, no multiplies at all
+
+The inner loops are written with the dual 16 bit instructions of the
+Cortex-M4: SMLALD multiplies two pairs of halfwords and adds both products to
+a 64 bit accumulator, QADD16 and QSUB16 add and subtract two pairs at once
+with saturation, SSUB16 and SEL take the minimum or maximum of two pairs. On
+a core without them, like the host, the same operations are done in plain C
+with the same saturation, so both give the same bits.
+
+*/
+
+// safeguards
+#ifndef dsp_h
+#define dsp_h
+
+#include <cstring>
+#include <climits>
+#include "gyro.h"
+
+// dsp values
+#define biquad_shift 14 // fraction bits of the biquad coefficients
+#define fir_shift 15 // fraction bits of the fir taps
+#define fir_taps_max 32 // taps of the longest fir
+#define average_shift_max 4 // longest moving average, 16 samples
+#define cic_order_max 4 // integrator and comb stages of the longest cic
+
+namespace Dsp{
+
+    //two halfwords in one word, low in bits 0-15
+    static inline int pack(short int low, short int high){
+        return (int)(((unsigned int)(unsigned short)high << 16) | (unsigned short)low);
+    }
+    static inline short int low(int pair){return (short int)(pair & 0xFFFF);}
+    static inline short int high(int pair){return (short int)(pair >> 16);}
+    //clamp to the range of a halfword
+    static inline short int saturate(long long value){
+        return (value > SHRT_MAX) ? SHRT_MAX : (value < SHRT_MIN) ? SHRT_MIN : (short int)value;
+    }
+    //two consecutive halfwords, the first one low
+    static inline int load(const short int *halfwords){
+        int pair;
+        memcpy(&pair, halfwords, sizeof(pair));
+        return pair;
+    }
+
+#if defined(__ARM_FEATURE_DSP)
+    static inline long long smlald(int a, int b, long long sum){return (long long)__SMLALD((uint32_t)a, (uint32_t)b, (uint64_t)sum);}
+    static inline int qadd16(int a, int b){return (int)__QADD16((uint32_t)a, (uint32_t)b);}
+    static inline int qsub16(int a, int b){return (int)__QSUB16((uint32_t)a, (uint32_t)b);}
+    //SEL reads the GE flags SSUB16 sets, one asm block so the compiler can not put anything between them
+    static inline int min16(int a, int b){
+        int result;
+        __asm__("ssub16 %0, %1, %2\n\tsel %0, %2, %1" : "=&r"(result) : "r"(a), "r"(b) : "cc");
+        return result;
+    }
+    static inline int max16(int a, int b){
+        int result;
+        __asm__("ssub16 %0, %1, %2\n\tsel %0, %1, %2" : "=&r"(result) : "r"(a), "r"(b) : "cc");
+        return result;
+    }
+#else
+    static inline long long smlald(int a, int b, long long sum){
+        return sum + (long long)low(a) * low(b) + (long long)high(a) * high(b);
+    }
+    static inline int qadd16(int a, int b){
+        return pack(saturate(low(a) + low(b)), saturate(high(a) + high(b)));
+    }
+    static inline int qsub16(int a, int b){
+        return pack(saturate(low(a) - low(b)), saturate(high(a) - high(b)));
+    }
+    static inline int min16(int a, int b){
+        return pack((low(a) >= low(b)) ? low(b) : low(a), (high(a) >= high(b)) ? high(b) : high(a));
+    }
+    static inline int max16(int a, int b){
+        return pack((low(a) >= low(b)) ? low(a) : low(b), (high(a) >= high(b)) ? high(a) : high(b));
+    }
+#endif
+
+    class Biquad{
+        public:
+            // constructor
+            Biquad();
+            // public methods
+            void setCoefficients(const short int *coefficients);
+            void setLowpass(int rate, int cutoff);
+            void reset();
+            void apply(Gyro::Sample *sample);
+        private:
+            int b0b1; // b0 low, b1 high
+            int b2a1; // b2 low, a1 high
+            short int a2;
+            short int state[3][4]; // x[n-1], x[n-2], y[n-1], y[n-2] of each axis
+    };
+
+    class MovingAverage{
+        public:
+            // constructor
+            MovingAverage(int shift = 0);
+            // public methods
+            void setShift(int shift);
+            void reset();
+            void apply(Gyro::Sample *sample);
+            int getDelay(){return ((1 << shift) - 1) / 2;}
+        private:
+            int shift; // the window is 1 << shift samples
+            int index; // where the next sample goes
+            int window[1 << average_shift_max][2]; // x y pair and z of each sample, shifted down
+            int sum[2]; // x y pair and z sums of the window
+    };
+
+    class Median{
+        public:
+            // constructor
+            Median();
+            // public methods
+            void reset();
+            void apply(Gyro::Sample *sample);
+        private:
+            int previous[2][2]; // x y pair and z of the last 2 samples, newest first
+            bool started;
+    };
+
+    class Fir{
+        public:
+            // constructor
+            Fir();
+            // public methods
+            bool setTaps(const short int *taps, int count, int factor);
+            void setLowpass(int count, int factor);
+            void reset();
+            bool decimate(const Gyro::Sample &input, Gyro::Sample *output);
+            int getFactor(){return factor;}
+            int getDelay(){return (count - 1) / 2;}
+        private:
+            short int taps[fir_taps_max]; // reversed, the tap of the oldest sample first
+            short int history[3][2 * fir_taps_max]; // every sample twice so the window is never split
+            int count; // taps, even
+            int factor;
+            int index; // where the next sample goes
+            int phase; // samples since the last output
+    };
+
+    class Cic{
+        public:
+            // constructor
+            Cic(int order = 1, int shift = 0);
+            // public methods
+            bool configure(int order, int shift);
+            void reset();
+            bool decimate(const Gyro::Sample &input, Gyro::Sample *output);
+            int getFactor(){return 1 << shift;}
+            int getDelay(){return order * ((1 << shift) - 1) / 2;}
+        private:
+            int order;
+            int shift; // the factor is 1 << shift
+            int phase; // samples since the last output
+            unsigned int integrators[3][cic_order_max]; // wrap around, only their differences are used
+            unsigned int combs[3][cic_order_max]; // last input of each comb
+    };
+}
+
+#endif
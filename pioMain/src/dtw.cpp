@@ -0,0 +1,184 @@
+#include "dtw.h"
+
+// Dtw constructor, sets the band half width in points
+Dtw::Dtw::Dtw(int band){
+    this->band = band;
+    tolerance = NULL;
+    key = NULL;
+    threshold = 0;
+    score = dtw_no_match;
+    length = 0;
+    width = band;
+    limit = dtw_infinity;
+    row = 0;
+    state = stream_rejected;
+}
+
+// Dtw public methods
+unsigned int Dtw::Dtw::compare(const Trace::Trace &a, const Trace::Trace &b, unsigned int threshold){
+    /*
+    Method used to find the dynamic time warping distance of two traces.
+    Row i of the cost matrix holds the cheapest path from the start to each
+    point j of b after matching the first i points of a. Only the cells
+    within the band of the diagonal are computed, the cells just outside it
+    are set to infinity so the next row never steps out of the band.
+
+    The band is widened to the length difference of the traces if needed,
+    otherwise the last cell could not be reached.
+
+    Every path crosses every row, so once the cheapest cell of a row costs
+    more than the threshold allows, the score can only be above it and the
+    comparison stops there.
+
+    Parameters:
+        a: first trace
+        b: second trace
+        threshold: highest score of interest, dtw_no_match to always finish
+    Returns:
+        the distance score, dtw_no_match if a trace is empty or the comparison was abandoned
+    */
+    int n = a.getSize();
+    start(&b, threshold, n);
+    for(int i = 0; (i < n) && (state == stream_pending); i++){
+        push(a[i]);
+    }
+    return score;
+}
+
+void Dtw::Dtw::start(const Trace::Trace *key, unsigned int threshold, int length){
+    /*
+    Method used to start a match against a key. The points of the password
+    are then given one at a time to push(). Without the length of the
+    password the match is a streaming one.
+
+    Parameters:
+        key: trace the password is matched against, must not change until the match ends
+        threshold: highest score accepted as the key
+        length: points of the password, 0 if not known yet
+    Returns:
+        None
+    */
+    this->key = key;
+    this->threshold = threshold;
+    this->length = length;
+    score = dtw_no_match;
+    row = 0;
+    int m = key->getSize();
+    state = (m == 0) ? stream_rejected : stream_pending;
+
+    width = band;
+    limit = dtw_infinity;
+    if(length > 0){
+        int difference = (length > m) ? length - m : m - length;
+        if(width < difference){
+            width = difference;
+        }
+        //limited to the costs the rows can hold
+        unsigned long long cost = ((unsigned long long)threshold + 1) * (unsigned int)(length + m) - 1;
+        if(cost < dtw_infinity){
+            limit = (unsigned int)cost;
+        }
+    }
+
+    rows[0][0] = 0;
+    for(int j = 1; j <= m; j++){
+        rows[0][j] = dtw_infinity;
+    }
+}
+
+Dtw::StreamState Dtw::Dtw::push(const Trace::Point &point){
+    /*
+    Method used to add the next point of the password to a match. One row
+    of the cost matrix is computed.
+
+    When streaming, once the band reaches the last point of the key, the
+    whole key is covered and the score of the path ending there is checked
+    against the threshold. The match is rejected when the band has moved
+    past the end of the key without accepting.
+
+    When the length is known, the match is decided on the last point of the
+    password. Every path crosses every row, so once the cheapest cell of a
+    row costs more than the threshold allows, the match is rejected there
+    with the score dtw_no_match.
+
+    Parameters:
+        point: the next point of the password
+    Returns:
+        the state of the match, points pushed after it ended are ignored
+    */
+    if(state != stream_pending){
+        return state;
+    }
+    int m = key->getSize();
+    row++;
+    int minimum = fillRow(point, *key, row, width, rows[(row - 1) & 1], rows[row & 1]);
+
+    if(length > 0){
+        if((unsigned int)minimum > limit){
+            state = stream_rejected;
+        }
+        else if(row == length){
+            score = (unsigned int)rows[row & 1][m] / (unsigned int)(row + m);
+            state = (score <= threshold) ? stream_accepted : stream_rejected;
+        }
+        return state;
+    }
+
+    if(row + band >= m){
+        score = (unsigned int)rows[row & 1][m] / (unsigned int)(row + m);
+        if(score <= threshold){
+            state = stream_accepted;
+        }
+        else if((row - band >= m) || (row >= trace_length)){
+            state = stream_rejected;
+        }
+    }
+    return state;
+}
+
+// Dtw private methods
+int Dtw::Dtw::fillRow(const Trace::Point &point, const Trace::Trace &key, int i, int w, const int *previous, int *current){
+    /*
+    Method used to compute row i of the cost matrix from row i - 1. Only the
+    cells within w points of the diagonal are computed, the cells just
+    outside it are set to infinity so the next row never steps out of the band.
+    The tolerance, when set, belongs to the key.
+
+    Parameters:
+        point: point i of the trace being matched
+        key: trace along the row
+        i: index of the row, starting at 1
+        w: band half width
+        previous: row i - 1
+        current: row i, written
+    Returns:
+        the cost of the cheapest cell of row i
+    */
+    int m = key.getSize();
+    int low = (i - w > 1) ? i - w : 1;
+    int high = (i + w < m) ? i + w : m;
+    int minimum = dtw_infinity;
+    current[low - 1] = dtw_infinity;
+    for(int j = low; j <= high; j++){
+        int best = previous[j - 1]; //match
+        if(previous[j] < best){
+            best = previous[j]; //a advances
+        }
+        if(current[j - 1] < best){
+            best = current[j - 1]; //b advances
+        }
+        if(tolerance != NULL){
+            current[j] = best + toleranceCost(point, key[j - 1], (*tolerance)[j - 1]);
+        }
+        else{
+            current[j] = best + pointCost(point, key[j - 1]);
+        }
+        if(current[j] < minimum){
+            minimum = current[j];
+        }
+    }
+    if(high < m){
+        current[high + 1] = dtw_infinity;
+    }
+    return minimum;
+}
@@ -0,0 +1,97 @@
+/*
+Dtw Class
+
+This class compares two angular rate traces with dynamic time warping, so
+a gesture done a little faster or slower than the key still lines up with
+it. The warping path is kept within a Sakoe-Chiba band of the diagonal,
+which bounds the work to O(n*w) cells, and only two rows of the cost
+matrix are kept. Everything is integer math: the local cost of two points
+is the sum of the absolute differences of their axes, accumulated in 32 bits.
+
+The result is a distance score, the cost of the best path divided by the
+lengths of both traces, so it can be compared with a threshold whatever the
+length of the gesture. Lower is closer. Given a threshold, the comparison
+is abandoned as soon as every path already costs more than it allows.
+
+A key built from several recordings comes with a tolerance for each of its
+points. When it is set, the difference on each axis within the tolerance of
+the key point is free.
+
+The matcher can also run on a stream: after start() is given the key, each
+point of the password computes one more row of the cost matrix as it arrives,
+O(w) work with O(key length) memory. As soon as the path reaches the end of
+the key with a score within the threshold, the password is accepted without
+waiting for the recording to end. Since the length of the password is not
+known yet, the streaming band is not widened. When the length is given to
+start(), the points are matched the same way as compare() does, which lets
+the points of one password be given to several matchers in a single pass.
+
+*/
+
+// safeguards
+#ifndef dtw_h
+#define dtw_h
+
+#include "trace.h"
+
+// dtw values
+#define dtw_infinity 0x3FFFFFFF // cost of cells outside the band, leaves room to add a local cost
+#define dtw_no_match 0xFFFFFFFF // score of a comparison with an empty trace
+
+namespace Dtw{
+
+    // state of a streaming match
+    enum StreamState{stream_pending, stream_accepted, stream_rejected};
+
+    // local cost of two points, the sum of the absolute differences of the axes
+    inline int pointCost(const Trace::Point &a, const Trace::Point &b){
+        int dx = a.x - b.x;
+        int dy = a.y - b.y;
+        int dz = a.z - b.z;
+        return (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy) + (dz < 0 ? -dz : dz);
+    }
+
+    // local cost of a point and a key point, the parts of the differences beyond the tolerance of the key point
+    inline int toleranceCost(const Trace::Point &a, const Trace::Point &b, const Trace::Point &tolerance){
+        int dx = a.x - b.x;
+        int dy = a.y - b.y;
+        int dz = a.z - b.z;
+        dx = (dx < 0 ? -dx : dx) - tolerance.x;
+        dy = (dy < 0 ? -dy : dy) - tolerance.y;
+        dz = (dz < 0 ? -dz : dz) - tolerance.z;
+        return (dx > 0 ? dx : 0) + (dy > 0 ? dy : 0) + (dz > 0 ? dz : 0);
+    }
+
+    class Dtw{
+        public:
+            // constructor
+            Dtw(int band = 0);
+            // public methods
+            unsigned int compare(const Trace::Trace &a, const Trace::Trace &b, unsigned int threshold = dtw_no_match);
+            void start(const Trace::Trace *key, unsigned int threshold, int length = 0);
+            StreamState push(const Trace::Point &point);
+            StreamState getState(){return state;}
+            unsigned int getScore(){return score;}
+            void setTolerance(const Trace::Trace *tolerance){this->tolerance = tolerance;}
+            void setBand(int band){this->band = band;}
+            int getBand(){return band;}
+        private:
+            // private methods
+            int fillRow(const Trace::Point &point, const Trace::Trace &key, int i, int w, const int *previous, int *current);
+            // private variables
+            int band;
+            const Trace::Trace *tolerance; // tolerance of each key point, NULL for none
+            int rows[2][trace_length + 1];
+            // streaming match
+            const Trace::Trace *key;
+            unsigned int threshold;
+            unsigned int score;
+            int length; // points of the password, 0 while streaming
+            int width; // band half width of the match
+            unsigned int limit; // largest path cost within the threshold
+            int row;
+            StreamState state;
+    };
+}
+
+#endif
@@ -0,0 +1,262 @@
+#include "envelope.h"
+#include <climits>
+
+// running maxima and minima of one axis of the projected password, shared by every envelope
+static short int forwardMax[trace_length];
+static short int forwardMin[trace_length];
+static short int backwardMax[trace_length];
+static short int backwardMin[trace_length];
+
+// Envelope constructor, starts empty
+Envelope::Envelope::Envelope(){
+    size = 0;
+    keySize = 0;
+    band = 0;
+    key = NULL;
+    tolerance = NULL;
+}
+
+// Envelope public methods
+void Envelope::Envelope::build(const Trace::Trace &key, const Trace::Trace *tolerance, int band){
+    /*
+    Method used to find the envelope of a key. Point i of the envelope spans
+    the key points from i - band to i + band. The envelope runs band points
+    past the end of the key so passwords up to band points longer are bounded.
+    The key and its tolerance are kept for projectionBound().
+
+    Parameters:
+        key: the key trace, must not change while the envelope is used
+        tolerance: tolerance of each key point, NULL for none
+        band: band half width in points, the one the matcher uses
+    Returns:
+        None
+    */
+    this->band = band;
+    this->key = &key;
+    this->tolerance = tolerance;
+    keySize = key.getSize();
+    size = keySize + band;
+    if(size > trace_length){
+        size = trace_length;
+    }
+    if(keySize == 0){
+        size = 0;
+    }
+
+    for(int i = 0; i < size; i++){
+        int low = (i - band > 0) ? i - band : 0;
+        int high = (i + band < keySize - 1) ? i + band : keySize - 1;
+        int top[3] = {SHRT_MIN, SHRT_MIN, SHRT_MIN};
+        int bottom[3] = {SHRT_MAX, SHRT_MAX, SHRT_MAX};
+        for(int j = low; j <= high; j++){
+            const Trace::Point &point = key[j];
+            int value[3] = {point.x, point.y, point.z};
+            int spread[3] = {0, 0, 0};
+            if(tolerance != NULL){
+                spread[0] = (*tolerance)[j].x;
+                spread[1] = (*tolerance)[j].y;
+                spread[2] = (*tolerance)[j].z;
+            }
+            for(int axis = 0; axis < 3; axis++){
+                if(value[axis] + spread[axis] > top[axis]){top[axis] = value[axis] + spread[axis];}
+                if(value[axis] - spread[axis] < bottom[axis]){bottom[axis] = value[axis] - spread[axis];}
+            }
+        }
+        //a point never goes past the short range, so saturating keeps the bound
+        for(int axis = 0; axis < 3; axis++){
+            upper[i][axis] = (top[axis] > SHRT_MAX) ? SHRT_MAX : (short int)top[axis];
+            lower[i][axis] = (bottom[axis] < SHRT_MIN) ? SHRT_MIN : (short int)bottom[axis];
+        }
+    }
+}
+
+unsigned int Envelope::Envelope::lowerBound(const Trace::Trace &password){
+    /*
+    Method used to find a lower bound of the dynamic time warping cost of a
+    password against the key, the LB_Keogh bound of the password plus the
+    projection bound of the key. The bound only holds while the matcher band
+    is not widened beyond the envelope band, so when the lengths differ by
+    more than the band the trivial bound 0 is returned.
+
+    Parameters:
+        password: the password trace
+    Returns:
+        a cost never above the cost of the best path, see rejects()
+    */
+    int n = password.getSize();
+    if(!covers(n)){
+        return 0;
+    }
+
+    unsigned int sum = 0;
+    for(int i = 0; i < n; i++){
+        sum += pointBound(i, password[i]);
+    }
+    return sum + projectionBound(password);
+}
+
+bool Envelope::Envelope::rejects(unsigned int bound, unsigned int threshold, int length){
+    /*
+    Method used to check if a lower bound of the cost rules out a score
+    within the threshold. The score is the cost divided by the lengths of both
+    traces and rounded down, so the highest cost it allows is one below the
+    threshold plus one times the lengths.
+
+    Parameters:
+        bound: lower bound of the cost of the password
+        threshold: highest score accepted as the key
+        length: points of the password
+    Returns:
+        true if the score of the password is above the threshold
+    */
+    unsigned long long allowed = ((unsigned long long)threshold + 1) * (unsigned int)(length + keySize) - 1;
+    return bound > allowed;
+}
+
+bool Envelope::Envelope::covers(int length){
+    /*
+    Method used to check if the envelope bounds a password of a given length,
+    which needs the lengths to differ by no more than the band.
+
+    Parameters:
+        length: points of the password
+    Returns:
+        true if pointBound() can be used on every point of the password
+    */
+    int difference = (length > keySize) ? length - keySize : keySize - length;
+    return (length > 0) && (keySize > 0) && (difference <= band) && (length <= size);
+}
+
+unsigned int Envelope::Envelope::pointBound(int i, const Trace::Point &point){
+    /*
+    Method used to find the distance of one password point to the envelope,
+    the least it can cost in any path. The lower bound is the sum over the
+    password.
+
+    Parameters:
+        i: index of the point in the password
+        point: the point
+    Returns:
+        the distance of the point to the envelope
+    */
+    int value[3] = {point.x, point.y, point.z};
+    unsigned int sum = 0;
+    for(int axis = 0; axis < 3; axis++){
+        if(value[axis] > upper[i][axis]){
+            sum += value[axis] - upper[i][axis];
+        }
+        else if(value[axis] < lower[i][axis]){
+            sum += lower[i][axis] - value[axis];
+        }
+    }
+    return sum;
+}
+
+unsigned int Envelope::Envelope::projectionBound(const Trace::Trace &password){
+    /*
+    Method used to find the second pass of the LB_Improved bound. The
+    password projected on the envelope lies between each password point and
+    every key point within the band, so a path costs at least the distance
+    of each password point to its projection, the LB_Keogh bound, plus the
+    distance of each key point to the projected points it is matched to.
+    Each key point is matched to some projected point within the band, so it
+    costs at least its distance to the lowest and highest of them. With a
+    tolerance the key point spans its tolerance on each side, which the
+    envelope holds.
+
+    The lowest and highest projected points of every window are found with
+    the van Herk/Gil-Werman filter, without branches: the projection is cut
+    into blocks as long as a window, running maxima and minima are taken
+    forward and backward within each block, and a window spans at most two
+    blocks, the end of one and the start of the next.
+
+    Parameters:
+        password: the password trace, covered by the envelope
+    Returns:
+        the cost added to the LB_Keogh bound, 0 if the envelope does not cover the password
+    */
+    int n = password.getSize();
+    if(!covers(n)){
+        return 0;
+    }
+
+    int width = 2 * band + 1;
+    int lastBlock = (n - 1) / width * width; // start of the block holding the last point
+    unsigned int sum = 0;
+    for(int axis = 0; axis < 3; axis++){
+        //running maxima and minima of the projection within each block
+        for(int start = 0; start < n; start += width){
+            int end = (start + width < n) ? start + width : n;
+            short int high = SHRT_MIN;
+            short int low = SHRT_MAX;
+            for(int i = start; i < end; i++){
+                short int value = project(password[i], i, axis);
+                high = (value > high) ? value : high;
+                low = (value < low) ? value : low;
+                forwardMax[i] = high;
+                forwardMin[i] = low;
+            }
+            high = SHRT_MIN;
+            low = SHRT_MAX;
+            for(int i = end - 1; i >= start; i--){
+                short int value = project(password[i], i, axis);
+                high = (value > high) ? value : high;
+                low = (value < low) ? value : low;
+                backwardMax[i] = high;
+                backwardMin[i] = low;
+            }
+        }
+
+        //distance of each key point to the projected points within the band
+        for(int j = 0; j < keySize; j++){
+            int first = j - band;
+            int last = (j + band < n - 1) ? j + band : n - 1;
+            int top;
+            int bottom;
+            if(first <= 0){
+                top = forwardMax[last]; // the window starts with the first block
+                bottom = forwardMin[last];
+            }
+            else if(first >= lastBlock){
+                top = backwardMax[first]; // the window ends with the last block
+                bottom = backwardMin[first];
+            }
+            else{
+                //the backward maxima stop at the end of a block, the forward ones start after it
+                top = (backwardMax[first] > forwardMax[last]) ? backwardMax[first] : forwardMax[last];
+                bottom = (backwardMin[first] < forwardMin[last]) ? backwardMin[first] : forwardMin[last];
+            }
+            const Trace::Point &point = (*key)[j];
+            int value = (axis == 0) ? point.x : ((axis == 1) ? point.y : point.z);
+            int spread = 0;
+            if(tolerance != NULL){
+                const Trace::Point &width = (*tolerance)[j];
+                spread = (axis == 0) ? width.x : ((axis == 1) ? width.y : width.z);
+            }
+            if(value - spread > top){
+                sum += value - spread - top;
+            }
+            else if(value + spread < bottom){
+                sum += bottom - value - spread;
+            }
+        }
+    }
+    return sum;
+}
+
+// Envelope private methods
+short int Envelope::Envelope::project(const Trace::Point &point, int i, int axis){
+    /*
+    Method used to project one axis of a password point on the envelope.
+
+    Parameters:
+        point: the password point
+        i: index of the point in the password
+        axis: 0 for x, 1 for y, 2 for z
+    Returns:
+        the value clamped between the lower and upper envelope
+    */
+    short int value = (axis == 0) ? point.x : ((axis == 1) ? point.y : point.z);
+    value = (value > upper[i][axis]) ? upper[i][axis] : value;
+    return (value < lower[i][axis]) ? lower[i][axis] : value;
+}
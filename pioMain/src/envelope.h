@@ -0,0 +1,62 @@
+/*
+Envelope Class
+
+This class holds the upper and lower envelope of a key trace, the highest
+and lowest value of each axis within the matching band around every point.
+It is built once when the key is recorded. When the key comes with a
+tolerance for each point, the envelope is widened by it.
+
+The envelope gives the LB_Keogh lower bound of the dynamic time warping
+cost of a password: every password point is matched to some key point
+within the band, so it costs at least its distance to the envelope. A
+second pass, the LB_Improved bound of Lemire, adds what the key still costs
+against the password projected on the envelope: every key point is matched
+to some projected point within the band, so it costs at least its distance
+to the envelope of the projection. Both passes are O(n) and much cheaper
+than the full alignment.
+
+The bound is a cost, the score of the alignment being the cost divided by
+the lengths of both traces. It is compared with the highest cost a
+threshold allows instead of being divided, so no remainder is lost.
+
+*/
+
+// safeguards
+#ifndef envelope_h
+#define envelope_h
+
+#include "trace.h"
+
+namespace Envelope{
+
+    class Envelope{
+        public:
+            // constructor
+            Envelope();
+            // public methods
+            void build(const Trace::Trace &key, const Trace::Trace *tolerance, int band);
+            unsigned int lowerBound(const Trace::Trace &password);
+            bool rejects(unsigned int bound, unsigned int threshold, int length);
+            bool covers(int length);
+            unsigned int pointBound(int i, const Trace::Point &point);
+            unsigned int projectionBound(const Trace::Trace &password);
+            int getSize(){return size;}
+            int getKeySize(){return keySize;}
+            const short int *getUpper(int i){return upper[i];}
+            const short int *getLower(int i){return lower[i];}
+            int getBand(){return band;}
+        private:
+            // private methods
+            short int project(const Trace::Point &point, int i, int axis);
+            // private variables
+            short int upper[trace_length][3]; // x, y, z, saturated once the tolerance is added
+            short int lower[trace_length][3];
+            int size; // points of the envelope, the key length plus the band
+            int keySize;
+            int band;
+            const Trace::Trace *key; // must not change while the envelope is used
+            const Trace::Trace *tolerance; // tolerance of each key point, NULL for none
+    };
+}
+
+#endif
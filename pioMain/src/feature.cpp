@@ -0,0 +1,224 @@
+#include "feature.h"
+#include <cmath>
+#include <cstdlib>
+#include <climits>
+
+// Feature constructor, windowShift is the log2 of the window length
+Feature::Feature::Feature(int windowShift){
+    if(windowShift < 1){windowShift = 1;}
+    if(windowShift > feature_window_max_shift){windowShift = feature_window_max_shift;}
+    shift = windowShift;
+    mask = (1 << shift) - 1;
+    reset();
+}
+
+// Feature public methods
+void Feature::Feature::reset(){
+    /*
+    Method used to fill the window with zeros and drop the snapshots.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    for(int axis = 0; axis < 3; axis++){
+        for(int i = 0; i <= mask; i++){
+            ring[axis][i] = 0;
+        }
+        sum[axis] = 0;
+        scatter[axis] = 0;
+        energy[axis] = 0;
+        crossings[axis] = 0;
+        // every zero in the window is equal, the newest one stands for them
+        lowest[axis][0] = mask;
+        highest[axis][0] = mask;
+        lowestHead[axis] = 0;
+        lowestSize[axis] = 1;
+        highestHead[axis] = 0;
+        highestSize[axis] = 1;
+    }
+    count = mask + 1;
+    phase = 0;
+    snapshotCount = 0;
+}
+
+void Feature::Feature::add(const Gyro::Sample &sample){
+    /*
+    Method used to slide the window one sample, the oldest sample leaves and
+    the new one enters. A snapshot is kept every window length samples.
+
+    Parameters:
+        sample: the next sample
+    Returns:
+        None
+    */
+    const short int values[3] = {sample.x, sample.y, sample.z};
+    const int length = mask + 1;
+    for(int axis = 0; axis < 3; axis++){
+        int value = values[axis];
+        int old = ring[axis][count & mask];
+        int next = ring[axis][(count + 1) & mask]; // oldest sample after this one
+        int newest = ring[axis][(count - 1) & mask];
+        // sliding Welford update, times the window length so it stays exact
+        int last = sum[axis];
+        sum[axis] += value - old;
+        scatter[axis] += (long long)(value - old) * ((long long)length * (value + old) - last - sum[axis]);
+        energy[axis] += value * value - old * old;
+        // the pair of the two oldest samples leaves, the newest pair enters
+        crossings[axis] += ((newest < 0) != (value < 0)) - ((old < 0) != (next < 0));
+        ring[axis][count & mask] = (short int)value;
+        // positions that left the window are dropped from the front of the queues
+        unsigned int first = count - mask;
+        if((int)(lowest[axis][lowestHead[axis]] - first) < 0){
+            lowestHead[axis] = (lowestHead[axis] + 1) & mask;
+            lowestSize[axis]--;
+        }
+        if((int)(highest[axis][highestHead[axis]] - first) < 0){
+            highestHead[axis] = (highestHead[axis] + 1) & mask;
+            highestSize[axis]--;
+        }
+        // positions that can no longer be the minimum or maximum are dropped from the back
+        while((lowestSize[axis] > 0) &&
+            (ring[axis][lowest[axis][(lowestHead[axis] + lowestSize[axis] - 1) & mask] & mask] >= value)){
+            lowestSize[axis]--;
+        }
+        lowest[axis][(lowestHead[axis] + lowestSize[axis]) & mask] = count;
+        lowestSize[axis]++;
+        while((highestSize[axis] > 0) &&
+            (ring[axis][highest[axis][(highestHead[axis] + highestSize[axis] - 1) & mask] & mask] <= value)){
+            highestSize[axis]--;
+        }
+        highest[axis][(highestHead[axis] + highestSize[axis]) & mask] = count;
+        highestSize[axis]++;
+    }
+    count++;
+    phase++;
+    if(phase > mask){
+        snapshot();
+    }
+}
+
+void Feature::Feature::finish(Vector *vector){
+    /*
+    Method used to end the gesture and pool the snapshots into the vector.
+    A partial last window is kept as a snapshot, each part of the vector is
+    the average of the snapshots in its share of the gesture, a part with no
+    snapshot of its own takes the nearest earlier one.
+
+    Parameters:
+        vector: pointer to the vector to fill
+    Returns:
+        None
+    */
+    if(phase > 0){
+        snapshot();
+    }
+    int entry = 0;
+    for(int part = 0; part < feature_parts; part++){
+        int first = part * snapshotCount / feature_parts;
+        int last = (part + 1) * snapshotCount / feature_parts;
+        if(last <= first){
+            last = first + 1;
+        }
+        for(int axis = 0; axis < 3; axis++){
+            for(int stat = 0; stat < feature_stats; stat++){
+                int total = 0;
+                if(snapshotCount > 0){
+                    for(int i = first; i < last; i++){
+                        total += snapshots[i][axis][stat];
+                    }
+                    total /= last - first;
+                }
+                vector->values[entry] = (short int)total;
+                entry++;
+            }
+        }
+    }
+}
+
+short int Feature::Feature::getMean(int axis){
+    /*
+    Method used to get the mean of an axis over the window.
+
+    Parameters:
+        axis: 0 for x, 1 for y, 2 for z
+    Returns:
+        the mean in raw units, rounded toward zero
+    */
+    return (short int)(sum[axis] / (1 << shift));
+}
+
+short int Feature::Feature::getDeviation(int axis){
+    /*
+    Method used to get the standard deviation of an axis over the window.
+
+    Parameters:
+        axis: 0 for x, 1 for y, 2 for z
+    Returns:
+        the deviation in raw units
+    */
+    float variance = (float)scatter[axis] / (float)(1LL << (2 * shift));
+    float deviation = sqrtf(variance);
+    return (short int)((deviation > SHRT_MAX) ? SHRT_MAX : deviation);
+}
+
+short int Feature::Feature::getRms(int axis){
+    /*
+    Method used to get the root mean square of an axis over the window, the
+    square root of its energy per sample.
+
+    Parameters:
+        axis: 0 for x, 1 for y, 2 for z
+    Returns:
+        the rms in raw units
+    */
+    float power = (float)energy[axis] / (float)(1 << shift);
+    float rms = sqrtf(power);
+    return (short int)((rms > SHRT_MAX) ? SHRT_MAX : rms);
+}
+
+// Feature private methods
+void Feature::Feature::snapshot(){
+    /*
+    Method used to keep the statistics of the window, snapshots past
+    feature_snapshots are not stored.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    phase = 0;
+    if(snapshotCount >= feature_snapshots){
+        return;
+    }
+    for(int axis = 0; axis < 3; axis++){
+        short int *stats = snapshots[snapshotCount][axis];
+        int crossing = crossings[axis] * feature_crossing_scale;
+        stats[0] = getMean(axis);
+        stats[1] = getDeviation(axis);
+        stats[2] = getRms(axis);
+        stats[3] = (short int)((crossing > SHRT_MAX) ? SHRT_MAX : crossing);
+        stats[4] = getMinimum(axis);
+        stats[5] = getMaximum(axis);
+    }
+    snapshotCount++;
+}
+
+// Vector public methods
+unsigned int Feature::Vector::distance(const Vector &other) const {
+    /*
+    Method used to compare two vectors.
+
+    Parameters:
+        other: the vector to compare with
+    Returns:
+        the average absolute difference of the entries in raw units
+    */
+    unsigned int total = 0;
+    for(int i = 0; i < feature_length; i++){
+        total += abs(values[i] - other.values[i]);
+    }
+    return total / feature_length;
+}
@@ -0,0 +1,84 @@
+/*
+Feature Class
+
+This class keeps running statistics of each axis of the gyro samples over a
+sliding window and turns a gesture into a feature vector of fixed length.
+
+Every statistic is updated in O(1) per sample from the sample entering the
+window and the one leaving it, the window ring is the only history kept:
+    -mean, from the running sum
+    -variance, with the sliding form of Welford's update, kept exactly in
+     integers as N times the sum of squared deviations
+    -energy, the running sum of squares, given as the rms
+    -zero crossings between consecutive samples of the window
+    -minimum and maximum, from monotonic queues of positions in the ring
+The window starts filled with zeros.
+
+Every window length samples the statistics of the window are kept as a
+snapshot. When the gesture ends the snapshots are pooled into feature_parts
+equal parts of the gesture, so the vector has the same length for every
+gesture and comparing two gestures is one pass over two short vectors.
+
+*/
+
+// safeguards
+#ifndef feature_h
+#define feature_h
+
+#include "gyro.h"
+
+// feature values
+#define feature_window_shift 8 // 256 samples per window, 320ms at 800Hz
+#define feature_window_max_shift 8 // longest window
+#define feature_stats 6 // mean, deviation, rms, zero crossings, minimum, maximum
+#define feature_parts 4 // parts of the gesture in the vector
+#define feature_snapshots 32 // windows kept per gesture, 10s at 800Hz
+#define feature_length (feature_parts * 3 * feature_stats)
+#define feature_crossing_scale 256 // raw units a zero crossing weighs in the vector
+
+namespace Feature{
+
+    // statistics of each part of a gesture, part major, then axis, then statistic
+    struct Vector{
+        short int values[feature_length];
+        unsigned int distance(const Vector &other) const;
+    };
+
+    class Feature{
+        public:
+            // constructor
+            Feature(int windowShift);
+            // public methods
+            void reset();
+            void add(const Gyro::Sample &sample);
+            void finish(Vector *vector);
+            short int getMean(int axis);
+            short int getDeviation(int axis);
+            short int getRms(int axis);
+            int getCrossings(int axis){return crossings[axis];}
+            short int getMinimum(int axis){return ring[axis][lowest[axis][lowestHead[axis]] & mask];}
+            short int getMaximum(int axis){return ring[axis][highest[axis][highestHead[axis]] & mask];}
+            int getSnapshots(){return snapshotCount;}
+        private:
+            // private methods
+            void snapshot();
+            // private variables
+            int shift;
+            int mask; // window length - 1
+            unsigned int count; // samples added since reset
+            int phase; // samples since the last snapshot
+            short int ring[3][1 << feature_window_max_shift];
+            int sum[3];
+            long long scatter[3]; // window length times the sum of squared deviations
+            long long energy[3]; // sum of squares
+            int crossings[3];
+            unsigned int lowest[3][1 << feature_window_max_shift]; // positions of increasing values
+            unsigned int highest[3][1 << feature_window_max_shift]; // positions of decreasing values
+            int lowestHead[3], lowestSize[3];
+            int highestHead[3], highestSize[3];
+            short int snapshots[feature_snapshots][3][feature_stats];
+            int snapshotCount;
+    };
+}
+
+#endif
@@ -1,18 +1,32 @@
 #include "gyro.h"
+#include "bias.h"
+#include <climits>
 
-// Gyro constructor, sets up SPI and chip select
-Gyro::Gyro::Gyro(PinName mosi, PinName miso, PinName sclk, PinName chip_select):
-    spi(mosi, miso, sclk), cs(chip_select)
+// Gyro constructor, sets up SPI, chip select and the data ready and motion interrupt pins
+Gyro::Gyro::Gyro(PinName mosi, PinName miso, PinName sclk, PinName chip_select, PinName data_ready, PinName motion):
+    spi(mosi, miso, sclk), cs(chip_select), dataReady(data_ready), motionIn(motion)
     {
-        spi.lock();
         spi.frequency(1000000); 
         spi.format(8,0); 
-        xPosition = 0;
-        yPosition = 0;
-        zPosition = 0;
-        xChange = 1;
-        yChange = 1;
-        zChange = 1;
+#if DEVICE_SPI_ASYNCH
+        spi.set_dma_usage(DMA_USAGE_ALWAYS);
+#endif
+        profile = &profileTable.profiles[profileIndex(odr_800hz, bw_highest, fs_245dps)];
+        bias[0] = 0;
+        bias[1] = 0;
+        bias[2] = 0;
+        fifoOverruns = 0;
+        sequence = 0;
+        readyTime = 0;
+        readySequence = 0;
+        readyFull = false;
+        missedSamples = 0;
+        burstIndex = 0;
+        burstLength = 0;
+        burstData = NULL;
+        for(int i = 0; i < burst_size; i++){
+            burstTx[i] = 0x00; //dummy bytes clocked out while reading
+        }
         cs = 1;
     }
 
@@ -25,15 +39,18 @@ Gyro::Gyro::~Gyro(){
 void Gyro::Gyro::init(){
     /*
     Gyro initialization method used to set up the gyro.
-    It writes to control register 1 and 2 to do the following:
+    It applies the recording profile:
     -sets the output data rate to 800Hz
     -sets the bandwidth to 110Hz
     -sets the power mode to normal
     -sets the axes to be enabled
-    -sets the high pass filter to be enabled
-    -sets the high pass filter cutoff frequency to 16Hz
+    -sets the full scale to 245dps
+    -sets the high pass filter cutoff frequency to 4Hz
+    -checks that the gyro responds
+    -measures the zero rate bias of each axis
 
-    Function also checks that the registers were written to correctly.
+    Function also checks that the registers were written to correctly. If
+    the gyro does not respond the bias is not calibrated.
 
     Parameters:
         None
@@ -43,82 +60,404 @@ void Gyro::Gyro::init(){
 
     printf("Initializing gyro...\n");
 
-    //write to ctrl_reg1 to enable all axes
-    cs = 0;
-    spi.write(write_no_incr | ctrl_reg1);
-    spi.write(setup_hex);
-    cs = 1;
-
-    //check that ctrl_reg1 was written to correctly
-    cs = 0;
-    spi.write(read_no_incr | ctrl_reg1);
-    char reg1 = spi.write(0x00);
-    cs = 1;
-    if(reg1 != setup_hex){
-        printf("Error: ctrl_reg1 was not written correctly\n");
+    if(!setProfile(odr_800hz, bw_highest, fs_245dps)){
+        printf("Error: control registers were not written correctly\n");
     }
 
-    //write to ctrl_reg2 to enable high pass filter
-    cs = 0;
-    spi.write(write_no_incr | ctrl_reg2);
-    spi.write(high_pass_filter);
-    cs = 1;
-
-    //check that ctrl_reg2 was written to correctly
-    cs = 0;
-    spi.write(read_no_incr | ctrl_reg2);
-    char reg2 = spi.write(0x00);
-    cs = 1;
-    if(reg2 != high_pass_filter){
-        printf("Error: ctrl_reg2 was not written correctly\n");
+    //check that the gyro is working, calibrating a silent gyro would only time out
+    if(!Gyro::check_gyro()){
+        printf("Error: Gyro not responding\n");
+        return;
     }
 
-    //check that the gyro is working
-    if(Gyro::check_gyro()){
-        printf("Gyro is initialized\n");
+    //measure the zero rate bias, the gyro must be still
+    printf("Calibrating gyro, keep it still...\n");
+    if(calibrate(calibration_attempts)){
+        printf("Gyro bias x: %d y: %d z: %d\n", bias[0], bias[1], bias[2]);
     }
     else{
-        printf("Error: Gyro not responding\n");
+        printf("Error: Gyro was not still, bias not calibrated\n");
+    }
+    printf("Gyro is initialized\n");
+}
+
+bool Gyro::Gyro::setProfile(DataRate rate, Bandwidth bandwidth, FullScale scale){
+    /*
+    Method used to switch the gyro to one of the profiles in profile.h.
+    It writes control registers 1, 2 and 4 and switches the thresholds
+    and the bias to the raw units of the new full scale, so they keep the
+    same angular rate.
+
+    Function also checks that the registers were written to correctly.
+
+    Parameters:
+        rate: output data rate
+        bandwidth: bandwidth setting of the rate
+        scale: full scale range
+    Returns:
+        true if the registers were written correctly, false otherwise
+    */
+    const Profile *next = &profileTable.profiles[profileIndex(rate, bandwidth, scale)];
+
+    //the bias is kept in raw units, so it follows the full scale
+    for(int axis = 0; axis < 3; axis++){
+        bias[axis] = (short int)((long)bias[axis] * profile->sensitivity / next->sensitivity);
+    }
+
+    writeRegister(ctrl_reg1, next->ctrl1);
+    writeRegister(ctrl_reg2, next->ctrl2);
+    writeRegister(ctrl_reg4, next->ctrl4);
+    profile = next;
+
+    return (readRegister(ctrl_reg1) == next->ctrl1) &&
+        (readRegister(ctrl_reg2) == next->ctrl2) &&
+        (readRegister(ctrl_reg4) == next->ctrl4);
+}
+
+bool Gyro::Gyro::calibrate(int attempts){
+    /*
+    Method used to measure the zero rate bias of each axis.
+    Samples are collected through the fifo into windows of running sums. The
+    mean of the first window in which the device was still becomes the bias.
+
+    The number of drains is bounded as well, twice what the windows take at
+    the current data rate, so a device that stops sending samples can not
+    keep the loop going.
+
+    Parameters:
+        attempts: number of windows to try before giving up
+    Returns:
+        true if the bias was measured, false if the device never was still
+    */
+    Bias::Bias window(bias_window_shift);
+    window.setStillThreshold(rawRate(still_rate_mdps));
+    Sample samples[fifo_depth];
+    int drainSamples = profile->rate * calibration_drain / 1000;
+    int drains = 2 * attempts * ((1 << bias_window_shift) / drainSamples + 1);
+
+    setBias(0, 0, 0);
+    enableFifo(0);
+    int tries = 0;
+    for(int drain = 0; (drain < drains) && (tries < attempts); drain++){
+        thread_sleep_for(calibration_drain);
+        int count = readFifo(samples, fifo_depth);
+        for(int i = 0; i < count; i++){
+            if(!window.add(samples[i])){
+                continue;
+            }
+            if(window.isStill()){
+                setBias(window.getX(), window.getY(), window.getZ());
+                disableFifo();
+                return true;
+            }
+            tries++;
+        }
     }
+    disableFifo();
+    return false;
+}
+
+void Gyro::Gyro::setBias(short int biasX, short int biasY, short int biasZ){
+    /*
+    Method used to set the bias subtracted from every sample.
+
+    Parameters:
+        biasX, biasY, biasZ: bias of each axis in raw units
+    Returns:
+        None
+    */
+    bias[0] = biasX;
+    bias[1] = biasY;
+    bias[2] = biasZ;
+}
+
+void Gyro::Gyro::adjustBias(short int deltaX, short int deltaY, short int deltaZ){
+    /*
+    Method used to correct the bias by the residual measured on samples that
+    already had the bias removed, used to track drift while the device is still.
+
+    Parameters:
+        deltaX, deltaY, deltaZ: residual bias of each axis in raw units
+    Returns:
+        None
+    */
+    bias[0] += deltaX;
+    bias[1] += deltaY;
+    bias[2] += deltaZ;
 }
 
 void Gyro::Gyro::readXYZ(){
     /*
     Method used to read the x, y, and z values from the gyro.
-    It first checks the status register to see if new data is available.
-    If new data is available, it reads the x, y, and z values from the
-    appropriate registers.
+    It reads the status register and the x, y, and z registers in one burst.
+    If the status register shows new data, the x, y, and z values are updated.
     If not, it returns.
 
-    It writes using incrementing address mode to read the x, y, and z values.
-
     Parameters:
         None
     Returns:
         None
     */
 
-    //check if new data is available
-    cs = 0;
-    spi.write(read_no_incr | status_reg);
-    char status = spi.write(0x00);
-    cs = 1;
-    if((status & new_data) == 0){
+    //read the status and x y z in a single burst starting at status_reg
+    const char *data = readBurst(status_reg, status_xyz_bytes);
+    if((data[0] & new_data) == 0){
         return;
     }
 
-    //read x y z using incrementing address mode
-    cs = 0;
-    spi.write(read_w_incr | out_x_h);
-    x = spi.write(0x00) << 8;
-    x |= spi.write(0x00);
+    Sample sample;
+    decodeSample(&data[1], &sample);
+    x = sample.x;
+    y = sample.y;
+    z = sample.z;
+}
 
-    y = spi.write(0x00) << 8;
-    y |= spi.write(0x00);
+void Gyro::Gyro::readOutput(){
+    /*
+    Method used to read the x, y, and z output registers without checking
+    the status register first.
 
-    z = spi.write(0x00) << 8;
-    z |= spi.write(0x00);
-    cs = 1;
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    Sample sample;
+    decodeSample(readBurst(out_x_l, sample_bytes), &sample);
+    x = sample.x;
+    y = sample.y;
+    z = sample.z;
+}
+
+void Gyro::Gyro::enableFifo(char watermark){
+    /*
+    Method used to turn on the 32 sample hardware fifo of the gyro.
+    The fifo is put in stream mode so the newest samples are always kept,
+    and the watermark level is set so the WTM flag rises once that many
+    samples are waiting. Any samples left in the fifo are discarded by
+    passing through bypass mode first.
+
+    Parameters:
+        watermark: number of samples (0 to 31) that sets the WTM flag
+    Returns:
+        None
+    */
+
+    //bypass mode empties the fifo
+    writeRegister(fifo_ctrl_reg, fifo_bypass_mode);
+    writeRegister(ctrl_reg5, readRegister(ctrl_reg5) | fifo_enable);
+    writeRegister(fifo_ctrl_reg, fifo_stream_mode | (watermark & fifo_watermark_mask));
+    fifoOverruns = 0;
+}
+
+void Gyro::Gyro::disableFifo(){
+    /*
+    Method used to turn off the hardware fifo of the gyro so the output
+    registers hold only the latest sample again.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    writeRegister(fifo_ctrl_reg, fifo_bypass_mode);
+    writeRegister(ctrl_reg5, readRegister(ctrl_reg5) & ~fifo_enable);
+}
+
+int Gyro::Gyro::readFifo(Sample *samples, int maxSamples){
+    /*
+    Method used to drain the hardware fifo of the gyro.
+    It reads fifo_src_reg to find how many samples are waiting, then reads
+    all of them in a single auto increment burst starting at out_x_l.
+    While the fifo is enabled the address wraps from out_z_h back to out_x_l,
+    so one chip select covers every sample.
+
+    If the fifo overran since the last drain, samples were lost; the overrun
+    is counted and the full fifo is read.
+
+    The fifo keeps no timestamps, so each sample gets the drain time minus
+    one output data period per newer sample.
+
+    The last sample read is also stored in x, y and z.
+
+    Parameters:
+        samples: array that will store the samples, oldest first
+        maxSamples: size of the samples array
+    Returns:
+        number of samples stored in the samples array
+    */
+
+    char source = readRegister(fifo_src_reg);
+    int count = source & fifo_level_mask;
+    if(source & fifo_overrun){
+        //FSS only counts to 31, an overrun means the fifo is full
+        fifoOverruns++;
+        count = fifo_depth;
+    }
+    else if(source & fifo_empty){
+        return 0;
+    }
+    if(count > maxSamples){
+        count = maxSamples; //the rest stays in the fifo for the next drain
+    }
+
+    const char *data = readBurst(out_x_l, count * sample_bytes);
+
+    //the newest sample was taken at most one period before the drain,
+    //the older ones are spaced one period apart before it
+    unsigned int period = 1000000 / profile->rate;
+    unsigned int newestTime = us_ticker_read();
+    for(int i = 0; i < count; i++){
+        decodeSample(&data[i * sample_bytes], &samples[i]);
+        samples[i].time = newestTime - (count - 1 - i) * period;
+        samples[i].sequence = sequence++;
+    }
+    if(count > 0){
+        x = samples[count - 1].x;
+        y = samples[count - 1].y;
+        z = samples[count - 1].z;
+    }
+    return count;
+}
+
+void Gyro::Gyro::enableDataReady(){
+    /*
+    Method used to start interrupt driven sampling. The data ready signal is
+    routed to INT2 and its rising edge is attached to dataReadyEvent().
+    The output registers are read once so a data ready level left high
+    from before is cleared and the next sample gives a fresh rising edge.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    missedSamples = 0;
+    readyFull = false;
+    dataEvents.clear(data_ready_flag);
+    dataReady.rise(callback(this, &Gyro::dataReadyEvent));
+    writeRegister(ctrl_reg3, readRegister(ctrl_reg3) | int2_data_ready);
+    readOutput();
+}
+
+void Gyro::Gyro::disableDataReady(){
+    /*
+    Method used to stop interrupt driven sampling.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    writeRegister(ctrl_reg3, readRegister(ctrl_reg3) & ~int2_data_ready);
+    dataReady.rise(NULL);
+    readyFull = false;
+    dataEvents.clear(data_ready_flag);
+}
+
+bool Gyro::Gyro::readSample(Sample *sample, uint32_t timeout){
+    /*
+    Method used to read one sample once the gyro signals it on INT2.
+    The calling thread sleeps on the data ready event instead of polling
+    status_reg, then reads x, y and z in one incrementing transfer. The
+    sample time and sequence number are taken from the mailbox the interrupt
+    fills, and the mailbox is emptied in the same critical section, so an
+    edge that lands after the wait returns is kept for the next call instead
+    of being read twice. Samples the reader was too late for show up as gaps
+    in the sequence.
+
+    If the wait times out while the data ready line is still high, a sample
+    was not read in time and no new edge will come, so it is read anyway.
+
+    Parameters:
+        sample: pointer to the sample that will store the reading
+        timeout: maximum time to wait in milliseconds
+    Returns:
+        true if a sample was read, false on timeout
+    */
+    while(true){
+        uint32_t flags = dataEvents.wait_any(data_ready_flag, timeout);
+        core_util_critical_section_enter();
+        if(readyFull){
+            sample->time = readyTime;
+            sample->sequence = readySequence;
+            readyFull = false;
+            core_util_critical_section_exit();
+            break;
+        }
+        if(flags & osFlagsError){
+            if(!dataReady.read()){
+                core_util_critical_section_exit();
+                return false;
+            }
+            sample->time = us_ticker_read();
+            sample->sequence = sequence++;
+            core_util_critical_section_exit();
+            break;
+        }
+        //the flag came from an edge whose mailbox the previous call already took
+        core_util_critical_section_exit();
+    }
+    readOutput();
+    sample->x = x;
+    sample->y = y;
+    sample->z = z;
+    return true;
+}
+
+void Gyro::Gyro::enableMotionWake(long mdps){
+    /*
+    Method used to arm the angular rate threshold interrupt on INT1.
+    The interrupt fires when the rate of any axis goes over the threshold and
+    stays latched until disableMotionWake(), so the program can sleep until
+    the device is actually moved.
+
+    Parameters:
+        mdps: threshold in millidegrees per second
+    Returns:
+        None
+    */
+    int threshold = rawRate(mdps) & int1_threshold_mask;
+    for(int axis = 0; axis < 3; axis++){
+        writeRegister(int1_ths_xh + 2 * axis, (char)(threshold >> 8));
+        writeRegister(int1_ths_xh + 2 * axis + 1, (char)(threshold & 0xFF));
+    }
+    writeRegister(int1_duration, 0x00); //fire on the first sample over the threshold
+    writeRegister(int1_cfg, int1_latch | int1_high_events);
+    readRegister(int1_src); //clear an interrupt latched from before
+
+    dataEvents.clear(motion_flag | motion_cancel_flag);
+    motionIn.rise(callback(this, &Gyro::motionEvent));
+    writeRegister(ctrl_reg3, readRegister(ctrl_reg3) | int1_enable);
+}
+
+void Gyro::Gyro::disableMotionWake(){
+    /*
+    Method used to disarm the angular rate threshold interrupt.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    writeRegister(ctrl_reg3, readRegister(ctrl_reg3) & ~int1_enable);
+    writeRegister(int1_cfg, 0x00);
+    motionIn.rise(NULL);
+    readRegister(int1_src); //release the latched interrupt
+}
+
+bool Gyro::Gyro::waitMotion(uint32_t timeout){
+    /*
+    Method used to sleep until the motion interrupt fires.
+    The wait also ends when cancelMotion() is called.
+
+    Parameters:
+        timeout: maximum time to wait in milliseconds
+    Returns:
+        true if motion was detected, false on timeout or cancel
+    */
+    uint32_t flags = dataEvents.wait_any(motion_flag | motion_cancel_flag, timeout);
+    return ((flags & osFlagsError) == 0) && (flags & motion_flag);
 }
 
 bool Gyro::Gyro::check_gyro(){
@@ -131,72 +470,236 @@ bool Gyro::Gyro::check_gyro(){
     Returns:
         True if the gyro is working properly, false otherwise
     */
-    cs = 0;
+    select();
     spi.write(read_no_incr | who_am_i);
     char who  = spi.write(0x00);
-    cs = 1;
+    deselect();
     return who == id;
 }
 
-void Gyro::Gyro::updatePosition(){
+void Gyro::Gyro::dataReadyEvent(){
     /*
-    Method used to update the x, y, and z positions of the gyro.
-    It calls the getPosition method for each axis.
+    Interrupt handler for the data ready rising edge. It only timestamps and
+    numbers the sample into the mailbox and wakes the reading thread, the SPI
+    read happens in readSample(). If the mailbox was never emptied the sample
+    in it is counted as missed.
 
     Parameters:
         None
     Returns:
         None
     */
-    readXYZ();
-    getPosition(&x, &xPosition, &xChange);
-    getPosition(&y, &yPosition, &yChange);
-    getPosition(&z, &zPosition, &zChange);
+    if(readyFull){
+        missedSamples++;
+    }
+    readyTime = us_ticker_read();
+    readySequence = sequence++;
+    readyFull = true;
+    dataEvents.set(data_ready_flag);
 }
 
-void Gyro::Gyro::getPosition(const short int *data, int *currentPosition, bool *change){
+bool Gyro::Gyro::startBurst(char address, int length, Callback<void(const char *, int)> done){
     /*
-    Method used to update the position of a single axis of the gyro.
-    It takes in the current data, the current position, and a boolean
-    indicating whether the position can be changed.
+    Method used to start an asynchronous read of consecutive gyro registers.
+    The SPI bus is locked and the transfer runs in the background into one of
+    two receive buffers, the CPU is free until it completes. When it does, the
+    done callback is called from the SPI interrupt with the received bytes.
+    finishBurst() must be called from the same thread to release the bus.
 
-    If the data is greater than the change trigger and the position can be
-    changed, the position is updated.
+    The receive buffers alternate, so the data of the previous burst stays
+    valid while the next one is being received.
 
-    If the data is less than the negative change trigger and the position can
-    be changed, the position is updated.
+    Parameters:
+        address: first register to read, auto increment is added
+        length: number of bytes to read, at most one full fifo
+        done: optional callback for when the transfer ends
+    Returns:
+        true if the transfer was started, false otherwise
+    */
+    if((length < 1) || (length > burst_size - 1)){
+        return false;
+    }
+    select();
+    burstLength = length;
+    burstDone = done;
+    burstTx[0] = read_w_incr | address;
+    dataEvents.clear(burst_done_flag);
+#if DEVICE_SPI_ASYNCH
+    if(spi.transfer(burstTx, length + 1, burstRx[burstIndex], length + 1,
+            callback(this, &Gyro::burstEvent), SPI_EVENT_ALL) != 0){
+        burstTx[0] = 0x00;
+        deselect();
+        return false;
+    }
+#else
+    //no asynchronous SPI on this target, the transfer blocks instead
+    spi.write(burstTx, length + 1, burstRx[burstIndex], length + 1);
+    burstEvent(SPI_EVENT_COMPLETE);
+#endif
+    return true;
+}
 
-    If the data is between the change trigger and the negative change trigger,
-    the position can be changed once again.
+const char *Gyro::Gyro::finishBurst(){
+    /*
+    Method used to wait for the burst started by startBurst() to complete.
+    The calling thread sleeps until the completion interrupt, then the SPI
+    bus is released. The command byte is only turned back into a dummy byte
+    here, the DMA clocks it out while the transfer runs.
 
     Parameters:
-        data: the current data from the gyro
-        currentPosition: the current position of the gyro
-        change: a boolean indicating whether the position can be changed
-    Returns:
         None
+    Returns:
+        pointer to the bytes read, valid until the burst after the next one
     */
+    dataEvents.wait_any(burst_done_flag);
+    burstTx[0] = 0x00;
+    deselect();
+    return burstData;
+}
 
-    if((*data > change_trigger) & *change){
-        //update position
-        if(*currentPosition == 0){
-            *currentPosition = 1;
-        }
-        else if(*currentPosition == 2){
-            *currentPosition = 0;
-        }
-        *change = 0; //set change to 0 so position can't be changed again
+const char *Gyro::Gyro::readBurst(char address, int length){
+    /*
+    Method used to read consecutive gyro registers with a burst and wait
+    for it to complete.
+
+    Parameters:
+        address: first register to read
+        length: number of bytes to read
+    Returns:
+        pointer to the bytes read
+    */
+    if(!startBurst(address, length)){
+        return &burstTx[1]; //dummy bytes, read as no new data and a zero sample
     }
-    else if((*data < -change_trigger) & *change){
-        if(*currentPosition == 0){
-            *currentPosition = 2;
-        }
-        else if(*currentPosition == 1){
-            *currentPosition = 0;
-        }
-        *change = 0; //set change to 0 so position can't be changed again
+    return finishBurst();
+}
+
+void Gyro::Gyro::burstEvent(int event){
+    /*
+    Interrupt handler for the end of a burst. The chip select is released
+    right away, the receive buffers are swapped and the done callback and
+    the waiting thread are notified. A transfer that ended with an error
+    gives the dummy bytes and a length of 0 to the callback instead.
+
+    Parameters:
+        event: SPI event flags
+    Returns:
+        None
+    */
+    cs = 1;
+    int length = 0;
+    if(event & SPI_EVENT_COMPLETE){
+        burstData = &burstRx[burstIndex][1]; //skip the byte clocked in with the command
+        burstIndex ^= 1;
+        length = burstLength;
+    }
+    else{
+        burstData = &burstTx[1]; //dummy bytes, read as no new data and a zero sample
+    }
+    if(burstDone){
+        burstDone(burstData, length);
+    }
+    dataEvents.set(burst_done_flag);
+}
+
+static inline short int removeBias(short int value, short int bias){
+    //saturate so a clipped reading can not wrap around and flip sign
+    int corrected = value - bias;
+    if(corrected > SHRT_MAX){
+        return SHRT_MAX;
     }
-    else if((*data < change_trigger) & (*data > -change_trigger)){
-        *change = 1; //set change to 1 so position can be changed again
+    if(corrected < SHRT_MIN){
+        return SHRT_MIN;
     }
-}
\ No newline at end of file
+    return (short int)corrected;
+}
+
+void Gyro::Gyro::decodeSample(const char *raw, Sample *sample){
+    /*
+    Method used to turn the 6 output register bytes into a sample.
+    The registers are little endian, low byte first. The bias is removed here
+    so every path that reads samples gets corrected values.
+
+    Parameters:
+        raw: the 6 bytes read starting at out_x_l
+        sample: pointer to the sample to fill
+    Returns:
+        None
+    */
+    const unsigned char *bytes = (const unsigned char *)raw;
+    sample->x = removeBias((short int)(bytes[0] | (bytes[1] << 8)), bias[0]);
+    sample->y = removeBias((short int)(bytes[2] | (bytes[3] << 8)), bias[1]);
+    sample->z = removeBias((short int)(bytes[4] | (bytes[5] << 8)), bias[2]);
+}
+
+void Gyro::Gyro::select(){
+    /*
+    Method used to start a transaction with the gyro. The SPI bus is locked
+    so the acquisition thread and the main thread can not interleave their
+    transactions, then chip select is pulled low.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    spi.lock();
+    cs = 0;
+}
+
+void Gyro::Gyro::deselect(){
+    /*
+    Method used to end a transaction with the gyro and release the SPI bus.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    cs = 1;
+    spi.unlock();
+}
+
+void Gyro::Gyro::motionEvent(){
+    /*
+    Interrupt handler for the motion rising edge, wakes the waiting thread.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    dataEvents.set(motion_flag);
+}
+
+void Gyro::Gyro::writeRegister(char reg, char value){
+    /*
+    Method used to write a single register of the gyro.
+
+    Parameters:
+        reg: address of the register
+        value: value to write
+    Returns:
+        None
+    */
+    select();
+    spi.write(write_no_incr | reg);
+    spi.write(value);
+    deselect();
+}
+
+char Gyro::Gyro::readRegister(char reg){
+    /*
+    Method used to read a single register of the gyro.
+
+    Parameters:
+        reg: address of the register
+    Returns:
+        value of the register
+    */
+    select();
+    spi.write(read_no_incr | reg);
+    char value = spi.write(0x00);
+    deselect();
+    return value;
+}
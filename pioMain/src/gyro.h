@@ -3,9 +3,29 @@ Gyro Class
 
 This class is used to interface with the I3G4250D Gyroscope. It uses the SPI
 interface to communicate with the device. The class is used to read the x, y, z
-angular acceleration values from the device. It also keeps track of the current
-position of the device. The position is updated when the angular acceleration
-values change by a certain amount.
+angular acceleration values from the device.
+
+The hardware fifo of the device can be enabled so samples keep being stored
+while the program is busy, and later drained in a single SPI burst.
+
+The data ready signal of the device (INT2) can be used so samples are only
+read once the device signals them, each one timestamped by the interrupt.
+Every sample carries the time it was taken, from the free running
+microsecond timer, and a sequence number, so rates and latencies can be
+measured exactly downstream.
+
+The zero rate bias of each axis is measured at startup while the device is
+still and subtracted from every sample as it is decoded.
+
+The data rate, bandwidth and full scale can be switched at runtime between
+the profiles in profile.h, the thresholds follow the full scale.
+
+The angular rate threshold interrupt of the device (INT1) can be armed so
+motion on any axis wakes the program, while the fifo keeps the samples that
+came just before it.
+
+Multi byte reads are done as asynchronous SPI bursts into two alternating
+receive buffers, so the CPU is free while the bytes are clocked.
 
 */
 
@@ -14,6 +34,7 @@ values change by a certain amount.
 #define gyro_h
 
 #include <mbed.h>
+#include "profile.h"
 
 // register addresses
 #define who_am_i 0x0F
@@ -30,6 +51,12 @@ values change by a certain amount.
 #define out_y_h 0x2B
 #define out_z_l 0x2C
 #define out_z_h 0x2D
+#define fifo_ctrl_reg 0x2E
+#define fifo_src_reg 0x2F
+#define int1_cfg 0x30
+#define int1_src 0x31
+#define int1_ths_xh 0x32 // followed by xl, yh, yl, zh, zl
+#define int1_duration 0x38
 
 // read and write commands
 #define read_no_incr 0x80 // write with address not incremented
@@ -38,48 +65,121 @@ values change by a certain amount.
 #define write_w_incr 0x40 // read with address incremented
 
 // data to write to registers
-#define setup_hex 0xFF
-#define high_pass_filter 0x04
 #define new_data 0x08
 #define id 211
 
-// position values
-#define change_trigger 20000
-#define reset_trigger 5000
+// fifo values
+#define fifo_enable 0x40 // FIFO_EN bit of ctrl_reg5
+#define fifo_bypass_mode 0x00 // FM2:0 = 000 in fifo_ctrl_reg
+#define fifo_stream_mode 0x40 // FM2:0 = 010 in fifo_ctrl_reg
+#define fifo_watermark_mask 0x1F // WTM4:0 in fifo_ctrl_reg
+#define fifo_overrun 0x40 // OVRN bit of fifo_src_reg
+#define fifo_empty 0x20 // EMPTY bit of fifo_src_reg
+#define fifo_level_mask 0x1F // FSS4:0 in fifo_src_reg
+#define fifo_depth 32 // number of samples the fifo can hold
+#define sample_bytes 6 // bytes per x, y, z sample
+
+// data ready values
+#define int2_data_ready 0x08 // I2_DRDY bit of ctrl_reg3
+#define data_ready_flag 0x01 // event flag set by the data ready interrupt
+
+// motion wake up values
+#define int1_enable 0x80 // I1_Int1 bit of ctrl_reg3
+#define int1_latch 0x40 // LIR bit of int1_cfg
+#define int1_high_events 0x2A // ZHIE, YHIE and XHIE bits of int1_cfg
+#define int1_threshold_mask 0x7FFF // thresholds are 15 bits
+#define motion_flag 0x04 // event flag set by the motion interrupt
+#define motion_cancel_flag 0x08 // event flag set to stop waiting for motion
+
+// burst values
+#define burst_done_flag 0x02 // event flag set when an SPI burst completes
+#define burst_size (1 + fifo_depth * sample_bytes) // command byte plus a full fifo
+#define status_xyz_bytes 7 // status_reg followed by the x, y, z output registers
+
+// calibration values
+#define calibration_attempts 10 // still windows tried at startup before giving up
+#define calibration_drain 20 // milliseconds between fifo drains while calibrating
 
 
 namespace Gyro{
 
+    // single x, y, z angular rate reading
+    struct Sample{
+        short int x;
+        short int y;
+        short int z;
+        unsigned int time; // microseconds on the free running timer when the sample was taken
+        unsigned int sequence; // sample number since startup, a gap means samples were lost
+    };
+
     class Gyro{
         public:
             // constructor and destructor
-            Gyro(PinName mosi, PinName miso, PinName sclk, PinName chip_select);
+            Gyro(PinName mosi, PinName miso, PinName sclk, PinName chip_select, PinName data_ready, PinName motion);
             ~Gyro();
             // public methods
             void init();
+            bool setProfile(DataRate rate, Bandwidth bandwidth, FullScale scale);
+            const Profile &getProfile(){return *profile;}
+            short int rawRate(long mdps){return (short int)(mdps * 100 / profile->sensitivity);}
+            bool calibrate(int attempts);
+            void setBias(short int biasX, short int biasY, short int biasZ);
+            void adjustBias(short int deltaX, short int deltaY, short int deltaZ);
+            short int getBiasX(){return bias[0];}
+            short int getBiasY(){return bias[1];}
+            short int getBiasZ(){return bias[2];}
             void readXYZ();
-            void updatePosition();
-            void center(){yPosition = 0; xPosition = 0; zPosition = 0;}
+            void enableFifo(char watermark);
+            void disableFifo();
+            int readFifo(Sample *samples, int maxSamples);
+            unsigned int getFifoOverruns(){return fifoOverruns;}
+            void enableDataReady();
+            void disableDataReady();
+            bool readSample(Sample *sample, uint32_t timeout);
+            unsigned int getMissedSamples(){return missedSamples;}
+            void enableMotionWake(long mdps);
+            void disableMotionWake();
+            bool waitMotion(uint32_t timeout);
+            void cancelMotion(){dataEvents.set(motion_cancel_flag);}
+            bool startBurst(char address, int length, Callback<void(const char *, int)> done = NULL);
+            const char *finishBurst();
             short int getX(){return x;}
             short int getY(){return y;}
             short int getZ(){return z;}
-            char getYPosition(){return yPosition;}
-            char getXPosition(){return xPosition;}
-            char getZPosition(){return zPosition;}
             bool check_gyro();
         private:
             SPI spi;
             DigitalOut cs;
+            InterruptIn dataReady;
+            InterruptIn motionIn;
+            EventFlags dataEvents;
+            volatile unsigned int sequence;
+            volatile unsigned int readyTime; // mailbox of the data ready interrupt:
+            volatile unsigned int readySequence; // time and number of the newest edge,
+            volatile bool readyFull; // until readSample() takes them
+            volatile unsigned int missedSamples;
             short int x;
             short int y;
             short int z;
-            int yPosition;
-            int xPosition;
-            int zPosition;
-            bool yChange;
-            bool xChange;
-            bool zChange;
-            void getPosition(const short int *data, int *currentPosition, bool *change);
+            const Profile *profile;
+            volatile short int bias[3];
+            unsigned int fifoOverruns;
+            char burstTx[burst_size];
+            char burstRx[2][burst_size];
+            int burstIndex;
+            int burstLength;
+            const char *burstData;
+            Callback<void(const char *, int)> burstDone;
+            void readOutput();
+            const char *readBurst(char address, int length);
+            void burstEvent(int event);
+            void decodeSample(const char *raw, Sample *sample);
+            void select();
+            void deselect();
+            void writeRegister(char reg, char value);
+            char readRegister(char reg);
+            void dataReadyEvent();
+            void motionEvent();
     };
 }
 
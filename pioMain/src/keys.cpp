@@ -0,0 +1,360 @@
+#include "keys.h"
+#include <climits>
+
+// Keys constructor, every slot starts empty
+Keys::Keys::Keys(int band){
+    this->band = band;
+    accepted = no_slot;
+    candidateCount = 0;
+    streamingCount = 0;
+    for(int slot = 0; slot < key_slots; slot++){
+        used[slot] = false;
+        bounds[slot] = 0;
+        matchers[slot].setBand(band);
+        matchers[slot].setTolerance(&tolerances[slot]);
+    }
+}
+
+// Keys public methods
+void Keys::Keys::enroll(int slot, const Moves::Moves *recordings, const Peaks::Peaks *events, const Feature::Vector *vectors, int count){
+    /*
+    Method used to put a key in use once its trace and tolerance are
+    written. The envelope of the key is built here, and the
+    moves and peak events of the key are taken from the recordings it was
+    enrolled from: for each, those of the recording with the smallest sum of
+    edit distances to the others, so one recording that went wrong does not
+    become the key. The feature vector of the key is the mean of the vectors
+    of every recording, so it sits in the middle of how the gesture varies.
+
+    Parameters:
+        slot: slot of the key
+        recordings: array of the moves of each recording
+        events: array of the peak events of each recording
+        vectors: array of the feature vectors of each recording
+        count: number of recordings
+    Returns:
+        None
+    */
+    int best = 0;
+    int bestSum = INT_MAX;
+    for(int i = 0; i < count; i++){
+        int sum = 0;
+        for(int j = 0; j < count; j++){
+            if(j != i){
+                sum += editors[slot].distance(recordings[i], recordings[j], max_moves);
+            }
+        }
+        if(sum < bestSum){
+            best = i;
+            bestSum = sum;
+        }
+    }
+    moves[slot].clear();
+    if(count > 0){
+        moves[slot] = recordings[best];
+    }
+
+    best = 0;
+    bestSum = INT_MAX;
+    for(int i = 0; i < count; i++){
+        int sum = 0;
+        for(int j = 0; j < count; j++){
+            if(j != i){
+                sum += events[i].distance(events[j], 2 * peak_max_events * peak_gap_cost);
+            }
+        }
+        if(sum < bestSum){
+            best = i;
+            bestSum = sum;
+        }
+    }
+    peaks[slot].clear();
+    if(count > 0){
+        peaks[slot] = events[best];
+    }
+
+    for(int i = 0; i < feature_length; i++){
+        int total = 0;
+        for(int r = 0; r < count; r++){
+            total += vectors[r].values[i];
+        }
+        features[slot].values[i] = (short int)((count > 0) ? total / count : 0);
+    }
+
+    envelopes[slot].build(traces[slot], &tolerances[slot], band);
+    used[slot] = true;
+}
+
+void Keys::Keys::erase(int slot){
+    /*
+    Method used to remove the key of a slot.
+
+    Parameters:
+        slot: slot of the key
+    Returns:
+        None
+    */
+    used[slot] = false;
+    traces[slot].clear();
+    tolerances[slot].clear();
+    moves[slot].clear();
+    peaks[slot].clear();
+}
+
+int Keys::Keys::getFree(){
+    /*
+    Method used to find a slot without a key.
+
+    Parameters:
+        None
+    Returns:
+        the first free slot, no_slot if every slot is used
+    */
+    for(int slot = 0; slot < key_slots; slot++){
+        if(!used[slot]){
+            return slot;
+        }
+    }
+    return no_slot;
+}
+
+int Keys::Keys::getShortest(){
+    /*
+    Method used to find the length of the shortest key. The streaming match
+    can not accept a password shorter than it by more than the band.
+
+    Parameters:
+        None
+    Returns:
+        the points of the shortest key, 0 if no slot is used
+    */
+    int shortest = 0;
+    for(int slot = 0; slot < key_slots; slot++){
+        if(used[slot] && ((shortest == 0) || (traces[slot].getSize() < shortest))){
+            shortest = traces[slot].getSize();
+        }
+    }
+    return shortest;
+}
+
+void Keys::Keys::start(unsigned int threshold, const int *slots, int count){
+    /*
+    Method used to start streaming a password to a list of keys.
+
+    Parameters:
+        threshold: highest dtw score accepted as a key
+        slots: array of the slots to stream to, NULL to stream to every used slot
+        count: number of slots in the array
+    Returns:
+        None
+    */
+    accepted = no_slot;
+    streamingCount = 0;
+    if(slots == NULL){
+        for(int slot = 0; slot < key_slots; slot++){
+            if(used[slot]){
+                streaming[streamingCount++] = slot;
+            }
+        }
+    }
+    else{
+        for(int i = 0; i < count; i++){
+            if((slots[i] >= 0) && (slots[i] < key_slots) && used[slots[i]]){
+                streaming[streamingCount++] = slots[i];
+            }
+        }
+    }
+    for(int k = 0; k < streamingCount; k++){
+        matchers[streaming[k]].start(&traces[streaming[k]], threshold);
+    }
+}
+
+int Keys::Keys::push(const Trace::Point &point){
+    /*
+    Method used to stream the next point of the password to the listed keys
+    that can still accept it.
+
+    Parameters:
+        point: the next point of the password
+    Returns:
+        the slot that accepted the password, no_slot if none yet
+    */
+    if(accepted != no_slot){
+        return accepted;
+    }
+    int kept = 0;
+    for(int k = 0; k < streamingCount; k++){
+        int slot = streaming[k];
+        Dtw::StreamState state = matchers[slot].push(point);
+        if(state == Dtw::stream_accepted){
+            accepted = slot;
+            break;
+        }
+        if(state != Dtw::stream_rejected){
+            streaming[kept++] = slot;
+        }
+    }
+    if(accepted == no_slot){
+        streamingCount = kept;
+    }
+    return accepted;
+}
+
+int Keys::Keys::verify(const Trace::Trace &trace, const Moves::Moves &attempt, const Peaks::Peaks &events, const Feature::Vector &vector, unsigned int threshold, int maxDistance, int maxEventDistance, unsigned int maxFeatureDistance, unsigned int *score, const int *slots, int count){
+    /*
+    Method used to check a password against the keys and find the closest.
+    The stages run from the cheapest to the dearest, each in one pass over
+    the password with every slot still in the list of candidates:
+        -the distance of the feature vectors, up to maxFeatureDistance
+        -the edit distance of the peak events, up to maxEventDistance
+        -the edit distance of the moves, up to maxDistance, skipped when the
+         bits that differ and the length difference are already within it
+        -the LB_Keogh bound of the trace from the envelopes, then the
+         projection bound of the keys still left, compared as costs
+        -the dynamic time warping score of the trace, abandoned per slot
+    A slot that accepted the streamed password goes through every stage as
+    well, the streaming match may have accepted a prefix of the gesture.
+    Every slot may be listed only once.
+
+    Parameters:
+        trace: the password trace
+        attempt: the password moves
+        events: the password peak events
+        vector: the password feature vector
+        threshold: highest dtw score accepted as a key
+        maxDistance: most moves the password may add, miss or change
+        maxEventDistance: largest edit distance of the peak events
+        maxFeatureDistance: largest distance of the feature vectors in raw units
+        score: pointer to the variable that will store the dtw score of the best slot
+        slots: array of the slots to check, NULL to check every used slot
+        count: number of slots in the array
+    Returns:
+        the slot of the closest key within the limits, no_slot if none
+    */
+    *score = dtw_no_match;
+    int n = trace.getSize();
+    int length = attempt.getSize();
+    if(n == 0){
+        return no_slot;
+    }
+
+    //list of the slots to check
+    candidateCount = 0;
+    if(slots == NULL){
+        for(int slot = 0; slot < key_slots; slot++){
+            if(used[slot]){
+                candidates[candidateCount++] = slot;
+            }
+        }
+    }
+    else{
+        for(int i = 0; i < count; i++){
+            if((slots[i] >= 0) && (slots[i] < key_slots) && used[slots[i]]){
+                candidates[candidateCount++] = slots[i];
+            }
+        }
+    }
+
+    //distance of the feature vectors
+    int kept = 0;
+    for(int k = 0; k < candidateCount; k++){
+        if(vector.distance(features[candidates[k]]) <= maxFeatureDistance){
+            candidates[kept++] = candidates[k];
+        }
+    }
+    candidateCount = kept;
+
+    //edit distance of the peak events
+    kept = 0;
+    for(int k = 0; k < candidateCount; k++){
+        if(events.distance(peaks[candidates[k]], maxEventDistance) <= maxEventDistance){
+            candidates[kept++] = candidates[k];
+        }
+    }
+    candidateCount = kept;
+
+    //moves that differ in few bits are within the edit distance, they go first and skip it
+    int close = 0;
+    for(int k = 0; k < candidateCount; k++){
+        int slot = candidates[k];
+        int difference = moves[slot].getSize() - length;
+        if(attempt.distance(moves[slot]) + ((difference > 0) ? difference : -difference) <= maxDistance){
+            candidates[k] = candidates[close];
+            candidates[close++] = slot;
+        }
+    }
+
+    //edit distance of the moves of the others
+    for(int k = close; k < candidateCount; k++){
+        editors[candidates[k]].start(moves[candidates[k]]);
+    }
+    for(int j = 0; (j < length) && (candidateCount > close); j++){
+        char move = attempt.getMove(j);
+        kept = close;
+        for(int k = close; k < candidateCount; k++){
+            int slot = candidates[k];
+            if(editors[slot].push(move) - (length - j - 1) <= maxDistance){
+                candidates[kept++] = slot;
+            }
+        }
+        candidateCount = kept;
+    }
+    kept = close;
+    for(int k = close; k < candidateCount; k++){
+        if(editors[candidates[k]].getDistance() <= maxDistance){
+            candidates[kept++] = candidates[k];
+        }
+    }
+    candidateCount = kept;
+
+    //lower bound of the trace from the envelopes
+    for(int k = 0; k < candidateCount; k++){
+        bounds[candidates[k]] = 0;
+    }
+    for(int i = 0; i < n; i++){
+        const Trace::Point &point = trace[i];
+        for(int k = 0; k < candidateCount; k++){
+            int slot = candidates[k];
+            if(envelopes[slot].covers(n)){
+                bounds[slot] += envelopes[slot].pointBound(i, point);
+            }
+        }
+    }
+    kept = 0;
+    for(int k = 0; k < candidateCount; k++){
+        int slot = candidates[k];
+        if(!envelopes[slot].rejects(bounds[slot], threshold, n)){
+            bounds[slot] += envelopes[slot].projectionBound(trace);
+            if(!envelopes[slot].rejects(bounds[slot], threshold, n)){
+                candidates[kept++] = slot;
+            }
+        }
+    }
+    candidateCount = kept;
+
+    //dynamic time warping of the trace
+    for(int k = 0; k < candidateCount; k++){
+        matchers[candidates[k]].start(&traces[candidates[k]], threshold, n);
+    }
+    for(int i = 0; i < n; i++){
+        const Trace::Point &point = trace[i];
+        kept = 0;
+        for(int k = 0; k < candidateCount; k++){
+            int slot = candidates[k];
+            if(matchers[slot].push(point) != Dtw::stream_rejected){
+                candidates[kept++] = slot;
+            }
+        }
+        candidateCount = kept;
+    }
+
+    int best = no_slot;
+    for(int k = 0; k < candidateCount; k++){
+        int slot = candidates[k];
+        if((matchers[slot].getState() == Dtw::stream_accepted) && (matchers[slot].getScore() < *score)){
+            best = slot;
+            *score = matchers[slot].getScore();
+        }
+    }
+    return best;
+}
@@ -0,0 +1,88 @@
+/*
+Keys Class
+
+This class stores the keys of several users, one per slot, and checks a
+password against all of them. Each part of a key is kept in its own array
+indexed by slot, the template trace, its tolerance, its envelope, its moves,
+its peak events and its feature vector, next to one matcher per slot.
+
+A password is checked against a list of slots, every used slot or the few
+candidates an index picked, in a single pass over each part of the password:
+the feature vectors are compared, then the peak events are compared with the events of every listed slot, then
+every move is given to the edit distance matcher of every listed slot whose
+moves are not already close bit for bit, then
+every point is bounded by the envelope of every listed slot, then the
+slots left are bounded against the password projected on their envelope,
+then every point goes through the dynamic time warping matcher of every
+listed slot. Slots drop out of the list at each stage once they can not
+match, so the cost grows linearly with the number of slots checked.
+
+With key_slots keys this class is several megabytes, so it is placed in the
+SDRAM instead of the internal RAM.
+
+While a password is recorded, its points can also be streamed to a list of
+slots so the recording ends as soon as it matches one of them. Only the
+slots still matching are visited for each point.
+
+*/
+
+// safeguards
+#ifndef keys_h
+#define keys_h
+
+#include <cstddef>
+#include "trace.h"
+#include "moves.h"
+#include "peaks.h"
+#include "feature.h"
+#include "envelope.h"
+#include "dtw.h"
+#include "levenshtein.h"
+
+// keys values
+#define key_slots 256 // users with a key on the device
+#define no_slot -1
+
+namespace Keys{
+
+    class Keys{
+        public:
+            // constructor
+            Keys(int band);
+            // public methods
+            Trace::Trace *getTrace(int slot){return &traces[slot];}
+            Trace::Trace *getTolerance(int slot){return &tolerances[slot];}
+            Moves::Moves *getMoves(int slot){return &moves[slot];}
+            const Peaks::Peaks *getPeaks(int slot){return &peaks[slot];}
+            const Feature::Vector *getFeatures(int slot){return &features[slot];}
+            void enroll(int slot, const Moves::Moves *recordings, const Peaks::Peaks *events, const Feature::Vector *vectors, int count);
+            void erase(int slot);
+            bool isUsed(int slot){return used[slot];}
+            int getFree();
+            int getShortest();
+            void start(unsigned int threshold, const int *slots = NULL, int count = 0);
+            int push(const Trace::Point &point);
+            int getAccepted(){return accepted;}
+            int verify(const Trace::Trace &trace, const Moves::Moves &attempt, const Peaks::Peaks &events, const Feature::Vector &vector, unsigned int threshold, int maxDistance, int maxEventDistance, unsigned int maxFeatureDistance, unsigned int *score, const int *slots = NULL, int count = 0);
+        private:
+            int band;
+            // one entry per slot
+            Trace::Trace traces[key_slots];
+            Trace::Trace tolerances[key_slots];
+            Envelope::Envelope envelopes[key_slots];
+            Moves::Moves moves[key_slots];
+            Peaks::Peaks peaks[key_slots];
+            Feature::Vector features[key_slots];
+            Dtw::Dtw matchers[key_slots];
+            Levenshtein::Levenshtein editors[key_slots];
+            bool used[key_slots];
+            short int streaming[key_slots]; // slots still matching the streamed password
+            int streamingCount;
+            short int candidates[key_slots]; // slots still matching the password being checked
+            int candidateCount;
+            unsigned int bounds[key_slots];
+            int accepted; // slot that accepted the streamed password, no_slot if none
+    };
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "levenshtein.h"
+
+// Levenshtein constructor
+Levenshtein::Levenshtein::Levenshtein(){
+    blocks = 0;
+    lastBit = 0;
+    score = 0;
+}
+
+// Levenshtein public methods
+int Levenshtein::Levenshtein::distance(const Moves::Moves &key, const Moves::Moves &password, int maxDistance){
+    /*
+    Method used to find the edit distance between the key and a password.
+    Since the distance can drop by at most one per password move left, the
+    search stops as soon as it can not come back within maxDistance.
+
+    Parameters:
+        key: the key moves, along the column
+        password: the password moves
+        maxDistance: largest distance of interest
+    Returns:
+        the edit distance, maxDistance + 1 if it is above maxDistance
+    */
+    int n = password.getSize();
+    start(key);
+    for(int j = 0; j < n; j++){
+        if(push(password.getMove(j)) - (n - j - 1) > maxDistance){
+            return maxDistance + 1;
+        }
+    }
+    return (score > maxDistance) ? maxDistance + 1 : score;
+}
+
+void Levenshtein::Levenshtein::start(const Moves::Moves &key){
+    /*
+    Method used to start a comparison against a key. The moves of the
+    password are then given one at a time to push().
+
+    Parameters:
+        key: the key moves, along the column
+    Returns:
+        None
+    */
+    int m = key.getSize();
+    blocks = (m + 31) / 32;
+    lastBit = (m > 0) ? 1u << ((m - 1) % 32) : 0;
+
+    //symbol masks of the key
+    for(int s = 0; s < edit_symbols; s++){
+        for(int b = 0; b < blocks; b++){
+            peq[s][b] = 0;
+        }
+    }
+    for(int i = 0; i < m; i++){
+        peq[symbol(key.getMove(i))][i / 32] |= 1u << (i % 32);
+    }
+
+    //the first column counts up from 0, every vertical difference is +1
+    for(int b = 0; b < blocks; b++){
+        pv[b] = 0xFFFFFFFF;
+        mv[b] = 0;
+    }
+    score = m;
+}
+
+int Levenshtein::Levenshtein::push(char move){
+    /*
+    Method used to add the next password move. It updates one column, block
+    by block from the first key move, carrying the horizontal difference of
+    the last cell of each block into the next. The distance is followed on
+    the last key move.
+
+    Parameters:
+        move: the next password move
+    Returns:
+        the edit distance between the key and the password moves so far
+    */
+    if(blocks == 0){
+        score++;
+        return score;
+    }
+
+    const uint32_t *eqs = peq[symbol(move)];
+    int hin = 1; //the first row counts up from 0 as well
+    for(int b = 0; b < blocks; b++){
+        uint32_t eq = eqs[b];
+        uint32_t xv = eq | mv[b];
+        if(hin < 0){
+            eq |= 1;
+        }
+        uint32_t xh = (((eq & pv[b]) + pv[b]) ^ pv[b]) | eq;
+        uint32_t ph = mv[b] | ~(xh | pv[b]);
+        uint32_t mh = pv[b] & xh;
+
+        if(b == blocks - 1){
+            //horizontal difference on the last key move
+            if(ph & lastBit){
+                score++;
+            }
+            else if(mh & lastBit){
+                score--;
+            }
+        }
+        int hout = (ph & 0x80000000) ? 1 : (mh & 0x80000000) ? -1 : 0;
+
+        ph <<= 1;
+        mh <<= 1;
+        if(hin < 0){
+            mh |= 1;
+        }
+        else if(hin > 0){
+            ph |= 1;
+        }
+        pv[b] = mh | ~(xv | ph);
+        mv[b] = ph & xv;
+        hin = hout;
+    }
+    return score;
+}
+
+// Levenshtein private methods
+int Levenshtein::Levenshtein::symbol(char move){
+    /*
+    Method used to number a move from 0 to 26.
+
+    Parameters:
+        move: the move, x in bits 0-1, y in bits 2-3 and z in bits 4-5
+    Returns:
+        the symbol of the move
+    */
+    return (move & 3) + 3 * ((move >> 2) & 3) + 9 * ((move >> 4) & 3);
+}
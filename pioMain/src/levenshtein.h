@@ -0,0 +1,54 @@
+/*
+Levenshtein Class
+
+This class finds the edit distance between two move sequences, the number
+of moves that have to be inserted, removed or changed to turn one into the
+other, so one extra or missing move does not fail a password.
+
+It uses the bit-parallel algorithm of Myers, in the blocked form of Hyyrö:
+each column of the edit distance matrix is kept as the vertical differences
+between its cells, one bit per key move in 32 bit words, and a whole column
+is updated with a few word operations per block. The work is
+O(n * ceil(m / 32)) and the memory is fixed by max_moves. The moves of a
+password can also be given one at a time after start().
+
+A move is one of 27 symbols, the 3 positions of each of the 3 axes.
+
+*/
+
+// safeguards
+#ifndef levenshtein_h
+#define levenshtein_h
+
+#include <stdint.h>
+#include "moves.h"
+
+// levenshtein values
+#define edit_symbols 27 // 3 positions on 3 axes
+#define edit_blocks ((max_moves + 31) / 32) // 32 bit words per column
+
+namespace Levenshtein{
+
+    class Levenshtein{
+        public:
+            // constructor
+            Levenshtein();
+            // public methods
+            int distance(const Moves::Moves &key, const Moves::Moves &password, int maxDistance);
+            void start(const Moves::Moves &key);
+            int push(char move);
+            int getDistance(){return score;}
+        private:
+            // private methods
+            int symbol(char move);
+            // private variables
+            uint32_t peq[edit_symbols][edit_blocks]; // bit i set where key move i is the symbol
+            uint32_t pv[edit_blocks]; // vertical differences of +1
+            uint32_t mv[edit_blocks]; // vertical differences of -1
+            int blocks;
+            uint32_t lastBit; // bit of the last key move in the last block
+            int score; // distance after the moves pushed so far
+    };
+}
+
+#endif
@@ -26,10 +26,29 @@ Usage:
     To change key:
         -user must long press (3s by default) the button while device is unlocked. NOTE: user can not
         change the key if the device is locked.
+    To add the key of another user:
+        -user must press the button for 6s while device is unlocked. Up to key_slots keys are stored and a
+        password unlocks the device if it matches any of them. A long press changes the key of the user that
+        last unlocked the device.
 */
 
 #include <mbed.h>
+#include <cstdlib>
+#include <new>
 #include "gyro.h"
+#include "ring.h"
+#include "bias.h"
+#include "trace.h"
+#include "dba.h"
+#include "segmenter.h"
+#include "dsp.h"
+#include "pipeline.h"
+#include "angle.h"
+#include "moves.h"
+#include "peaks.h"
+#include "feature.h"
+#include "keys.h"
+#include "vptree.h"
 #include "drivers/LCD_DISCO_F429ZI.h"
 
 //---------------------------------------------Global Constants--------------------------------------------------
@@ -44,14 +63,54 @@ Usage:
 #define miso PF_8
 #define sclk PF_7
 #define chip_select PC_1
-
-//maximum recording size for the gyro
-#define maxRecording 5
+//gyro INT2 pin, used as the data ready signal
+#define data_ready PA_2
+//gyro INT1 pin, used as the motion signal
+#define motion PA_1
 
 //time constants
 #define longPressTime 3000000 //3 seconds in microseconds used to determine long press on button
+#define addKeyPressTime 6000000 //6 seconds in microseconds used to determine the press adding a new key
 #define timeoutTime 15000000 //15 seconds in microseconds used to determine timeout on gyro recording
 
+//gyro profiles, a low rate while idle to cut SPI load and power, the full rate only while recording
+#define idleProfile Gyro::odr_100hz, Gyro::bw_highest, Gyro::fs_245dps
+#define recordProfile Gyro::odr_800hz, Gyro::bw_highest, Gyro::fs_245dps
+
+//sample ring constants
+#define ringSize 256 //gyro samples held between the acquisition thread and the recording, 320ms at 800Hz
+#define batchSize 32 //gyro samples taken out of the ring at once
+#define sampleTimeout 50 //50 milliseconds, longest wait for a gyro sample before checking for motion arming
+#define wakeSamples 16 //gyro samples in the ring before the recording is woken up, 20ms at 800Hz
+
+//event flags
+#define samplesFlag 0x01 //set by the acquisition thread when samples are waiting in the ring
+#define buttonFlag 0x02 //set by the button interrupt when a press ends
+#define timeoutFlag 0x04 //set when the recording timeout expires
+#define motionFlag 0x08 //set by the acquisition thread when the gyro detected motion while locked
+
+//rate on any axis that starts a password attempt while locked, in millidegrees per second
+#define motionTrigger 100000
+
+//password matching constants
+#define noiseCutoff 40 //cutoff in Hz of the low pass the recorded samples go through
+#define displayFactor 4 //matching samples per sample of the live graph, 12.5Hz at 800Hz
+
+#define matchBand 25 //trace points the password may lead or lag the key, 500ms at 50Hz
+#define matchThreshold 45000 //highest dtw score accepted as the key, in millidegrees per second
+#define enrollRepetitions 5 //recordings of the key averaged into its template
+#define moveTolerance 2 //moves a password may add, miss or change from the key
+#define eventTolerance 8 //edit distance of the peak events allowed, two missing events or several changed buckets
+#define featureTolerance 30000 //average difference of the gesture features allowed, in millidegrees per second
+#define matchCandidates 3 //closest keys from the index checked against the password first
+#define radiusFactor 4 //signature distance of the index accepted per signature point and unit of matchThreshold
+
+//SDRAM placement, the LCD frame buffers use the first 3MB
+#define keysAddress (SDRAM_DEVICE_ADDR + 0x300000)
+#define indexAddress (keysAddress + ((sizeof(Keys::Keys) + 7) & ~7))
+static_assert(key_slots <= vptree_capacity, "the index can not hold every key slot");
+static_assert(indexAddress + sizeof(Vptree::Vptree) <= SDRAM_DEVICE_ADDR + SDRAM_DEVICE_SIZE, "keys do not fit in the SDRAM");
+
 
 //--------------------------------------------Global Objects--------------------------------------------------
 
@@ -62,17 +121,54 @@ LCD_DISCO_F429ZI lcd;
 InterruptIn button(USER_BUTTON);
 
 //gyro object
-Gyro::Gyro gyro(mosi, miso, sclk, chip_select);
+Gyro::Gyro gyro(mosi, miso, sclk, chip_select, data_ready, motion);
+
+//sample ring filled by the acquisition thread
+Ring::Ring<Gyro::Sample, ringSize> sampleRing;
+
+//thread reading the gyro, above normal so the main thread can not starve it
+Thread acquisitionThread(osPriorityAboveNormal);
 
 //timer for button press
 Timer timer;
-//timer for timeout
-Timer timeoutTimer;
+//timeout for recordings
+Timeout recordTimeout;
+
+//events the main thread sleeps on
+EventFlags events;
+
+//keys of every user and their matchers, in the SDRAM set up by the lcd constructor
+Keys::Keys *keys = new ((void *)keysAddress) Keys::Keys(matchBand);
+
+//index of the key templates finding the keys closest to a password
+Vptree::Vptree *keyIndex = new ((void *)indexAddress) Vptree::Vptree();
+
+//filters removing single sample spikes and noise from the recorded samples
+Dsp::Median spikeFilter;
+Dsp::Biquad noiseFilter;
+
+//pipeline splitting the recorded samples into the matching and display streams
+Pipeline::Pipeline pipeline;
+
+//integrator turning the recorded rates into angles and angle steps
+Angle::Angle angles;
+
+//window statistics of the gesture turned into its feature vector
+Feature::Feature featureWindow(feature_window_shift);
+
+//segmenter finding the start and end of the gesture in a recording
+Segmenter::Segmenter segmenter(segment_window_shift, segment_hold);
+
+//averager merging the key recordings into the key template
+Dba::Dba averager;
+
+//cpu usage when the last recording started, needs MBED_CPU_STATS_ENABLED
+mbed_stats_cpu_t cpuStart;
 
 //---------------------------------------------Custom Types--------------------------------------------------
 
 //enum for button press status
-enum ButtonPress{notPress, shortPress, longPress};
+enum ButtonPress{notPress, shortPress, longPress, addKeyPress};
 //enum for state of the device
 enum State{locked, unlocked};
 //enum for LCD state
@@ -88,18 +184,65 @@ enum LCDState
     KeyStored,
 };
 
+//statistics of a recording, measured from the sample timestamps and sequence numbers
+struct RecordingStats{
+    unsigned int samples;
+    unsigned int firstTime;
+    unsigned int lastTime;
+    unsigned int firstSequence;
+    unsigned int lastSequence;
+    unsigned int maxLatency; //longest time from the gyro interrupt until the sample was used
+    unsigned int cpuBusy; //share of the recording the cpu was awake, in percent
+};
+
 //---------------------------------------------Global Variables--------------------------------------------------
 
-//last x, y, z positions recorded by the gyro
-char xPosition, yPosition, zPosition = 0;
+//Q8 bias left in the samples after the gyro bias, written by the acquisition thread
+volatile short int biasFraction[3] = {0, 0, 0};
+
+//moves of the last password attempt
+Moves::Moves passwordMoves;
+
+//peak events of the last password attempt
+Peaks::Peaks passwordPeaks;
+
+//feature vector of the last password attempt
+Feature::Vector passwordFeatures;
+
+//angular rate trace of the last password attempt
+Trace::Trace passwordTrace;
+//recordings of the key being enrolled, their moves, peak events and feature vectors, from enrollKey()
+Trace::Trace keyRecordings[enrollRepetitions];
+Moves::Moves keyMoves[enrollRepetitions];
+Peaks::Peaks keyPeaks[enrollRepetitions];
+Feature::Vector keyFeatures[enrollRepetitions];
 
-//password recording buffer
-char recordings[maxRecording][3];
-int recordingSize = 0;
+//keys from the index, closest first, the password is checked against
+int indexSlots[key_slots];
+unsigned int indexDistances[key_slots];
 
-//key buffer
-char key[maxRecording][3];
-int keySize = 0;
+//trace points recorded before the password is streamed to the keys closest to it, 0 once it is streamed
+int streamStart = 0;
+
+//key slot of the user that last unlocked the device
+int activeSlot = 0;
+
+//keys the last password was checked against, from checkPassword()
+int checkedKeys = 0;
+
+//batch of samples taken out of the sample ring
+Gyro::Sample batch[batchSize];
+
+//set while the acquisition thread should sleep until the gyro detects motion
+volatile bool motionArmed = false;
+
+//samples from just before the last motion trigger, written by the acquisition thread before it sets motionFlag
+Gyro::Sample history[fifo_depth];
+int historySize = 0;
+unsigned int historyRate = 0; //data rate the history was taken at, in Hz
+
+//statistics of the last recording
+RecordingStats recordingStats;
 
 //button status
 ButtonPress buttonStatus = notPress;
@@ -111,71 +254,101 @@ uint32_t graph_width = lcd.GetXSize() - 2 * GRAPH_PADDING;
 uint32_t graph_height = lcd.GetYSize() - 2 * GRAPH_PADDING;
 //LCD text buffer
 char display_buf[2][60];
+//column of the live graph the next display sample is drawn in, and the last height drawn on each axis
+uint32_t plotColumn = 0;
+uint32_t plotLast[3];
 
 //---------------------------------------------Functions Declarations--------------------------------------------------
-void showPosition(Gyro::Gyro *gyro);
-void showXYZ(Gyro::Gyro *gyro);
+void showXYZ(const Gyro::Sample &sample);
 bool checkPassword(void);
 void raiseEvent(void);
 void fallEvent(void);
-void recordGyro(char (*data)[3], int *size, bool timeoutAct);
+void timeoutEvent(void);
+void recordGyro(Moves::Moves *moves, Peaks::Peaks *peaks, Feature::Vector *features, Trace::Trace *trace, Keys::Keys *stream, bool timeoutAct, bool preTrigger);
+void enrollKey(int slot, bool timeoutAct);
+void acquireGyro(void);
+void watchMotion(void);
+void armMotion(void);
+void disarmMotion(void);
+void recordSample(const Gyro::Sample &sample, Moves::Moves *moves, Peaks::Peaks *peaks, Trace::Trace *trace, Keys::Keys *stream);
+void recordHistory(Moves::Moves *moves, Peaks::Peaks *peaks, Trace::Trace *trace, Keys::Keys *stream);
+void streamPoint(Trace::Trace *trace, Keys::Keys *stream);
+void measureSample(const Gyro::Sample &sample);
+void printStats(void);
+void trackBias(Bias::Bias *tracker, const Gyro::Sample &sample);
 void updateLCD(LCDState state);
+void plotSample(const Gyro::Sample &sample);
 
 //----------------------------------------------Functions Definitions--------------------------------------------------
-void showPosition(Gyro::Gyro *gyro){
+void showXYZ(const Gyro::Sample &sample){
     /*
     NOT CURRENTLY USED
-    Helper function to show current x, y, and z positions (centered 0, positive 1, negative 2) values.
+    Helper function to show a sample's x, y, and z angular acceleration values with its time in microseconds
+    and sequence number, in the format read by gyro_plotter.py.
     Parameters:
-        gyro: pointer to the gyro object
+        sample: the sample to show
     Returns:
         None
     */
-    gyro->updatePosition();
-    if( (gyro->getYPosition() != yPosition) || 
-            (gyro->getXPosition() != xPosition) || 
-            (gyro->getZPosition() != zPosition))
-        {
-            yPosition = gyro->getYPosition();
-            xPosition = gyro->getXPosition();
-            zPosition = gyro->getZPosition();
-            printf("x loc: %d  y loc: %d  z loc: %d\n", xPosition, yPosition, zPosition);
-            printf("--------------------------------\n");
-        }
-}
-
-void showXYZ(Gyro::Gyro *gyro){
-    /*
-    NOT CURRENTLY USED
-    Helper function to show current x, y, and z angular acceleration values.
-    Parameters:
-        gyro: pointer to the gyro object
-    Returns:
-        None
-    */
-    gyro->readXYZ();
-    printf("x: %d y: %d z: %d\n", gyro->getX(), gyro->getY(), gyro->getZ());
+    printf("x: %d y: %d z: %d t: %u n: %u\n", sample.x, sample.y, sample.z, sample.time, sample.sequence);
 }
 
 bool checkPassword(void){
     /*
-    Function checks if the recorded key matches the entered password.
+    Function checks if the entered password matches the key of any user. The key index first picks the
+    matchCandidates keys with the closest signatures, then the password is checked against those keys in a single
+    pass: the distance of the feature vectors and the edit distances of the peak events and of the moves first, then the lower bounds of the trace from the
+    key envelopes, then the dynamic time warping score of the trace, so most wrong passwords never pay for the full
+    alignment. The key that accepted the password while it was streamed is checked first, through the same stages,
+    since the streaming match only looked at the trace, maybe only a part of it.
+    The signature distance of the index does not bound the dtw score, so a key ranked further away can still match:
+    when none of the closest keys matches, the keys not checked yet whose signatures are within the acceptance radius
+    of the password are checked in a second and last round. The radius is radiusFactor times the dtw threshold for
+    every signature point, the distance the signatures of the gestures of the recordings within the threshold of
+    each other stayed below, and the index skips every subtree beyond it, so a wrong password is only checked
+    against the few keys near it instead of every key.
+    The user of the closest key of the round that matched becomes the active user.
     Parameters:
         None
     Returns:
-        true if the key matches the password
-        false if the key does not match the password
+        true if the password matches a key
+        false if the password does not match any key
     */
-
-    if(recordingSize != keySize){return false;} //check if the sizes are the same to avoid out of bounds error
-    for (int i = 0; i < recordingSize; i++){ //loop through each element of the array
-        if(recordings[i][0] != key[i][0] || 
-            recordings[i][1] != key[i][1] || 
-            recordings[i][2] != key[i][2])
-        {
-            return false;
+    unsigned int score;
+    unsigned int threshold = gyro.rawRate(matchThreshold);
+    unsigned int radius = radiusFactor * signature_length * threshold;
+    int candidates[key_slots];
+    bool checked[key_slots] = {false}; //keys checked in the first round, keys at the same distance may swap ranks
+    int streamed = keys->getAccepted();
+    int slot = no_slot;
+    int count = 0;
+    checkedKeys = 0;
+    if(streamed != no_slot){
+        candidates[count++] = streamed;
+        checked[streamed] = true;
+    }
+    for (int round = 0; (round < 2) && (slot == no_slot); round++){
+        int found = (round == 0) ? keyIndex->nearest(passwordTrace, matchCandidates, indexSlots, indexDistances)
+            : keyIndex->nearest(passwordTrace, key_slots, indexSlots, indexDistances, radius);
+        for (int i = 0; i < found; i++){
+            if(!checked[indexSlots[i]]){
+                candidates[count++] = indexSlots[i]; //each slot once, verify() keeps one match per slot
+                checked[indexSlots[i]] = true;
+            }
+        }
+        if(count > 0){
+            slot = keys->verify(passwordTrace, passwordMoves, passwordPeaks, passwordFeatures, threshold, moveTolerance,
+                eventTolerance, gyro.rawRate(featureTolerance), &score, candidates, count);
         }
+        checkedKeys += count;
+        count = 0;
     }
+    if(slot == no_slot){
+        printf("no key matched, %d keys checked\n", checkedKeys);
+        return false;
+    }
+    printf("key %d matched, dtw score: %u%s\n", slot, score, (slot == streamed) ? ", accepted while recording" : "");
+    activeSlot = slot;
     return true;
 }
 
@@ -204,70 +377,436 @@ void fallEvent(void){
         None
     */
     timer.stop(); //stop timer
-    if(timer.elapsed_time().count() > longPressTime){ //check if long press
+    if(timer.elapsed_time().count() > addKeyPressTime){ //check if press adding a key
+        buttonStatus = addKeyPress;
+    }
+    else if(timer.elapsed_time().count() > longPressTime){ //check if long press
         buttonStatus = longPress;
     }
     else{ //if not long press, then short press
         buttonStatus = shortPress;
     }
     timer.reset();
+    events.set(buttonFlag); //wake the main thread
+}
+
+void timeoutEvent(void){
+    /*
+    Interrupt handler for the recording timeout.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    events.set(timeoutFlag);
 }
 
-void recordGyro(char (*data)[3], int *size, bool timeoutAct){
+void recordGyro(Moves::Moves *moves, Peaks::Peaks *peaks, Feature::Vector *features, Trace::Trace *trace, Keys::Keys *stream, bool timeoutAct, bool preTrigger){
     /*
-    Function records the change in the gyro's x, y, and z locations using the gyro's updatePosition() function.
-    The function will record the change in location until the maxRecording is reached, the button is pressed,
-    or the timeoutTime is reached(if active).
+    Function records the steps of the angle the gyro turned through on the x, y, and z axes.
+    The function sleeps on events between batches of samples taken from the sample ring, so the core can sleep.
+    The function will record the change in location until the button is pressed, the gesture ends or the
+    timeoutTime is reached(if active). When the keys are given to stream the trace to, the recording also
+    ends as soon as one of them accepts it, see streamPoint(). Only the samples of the gesture are added to the trace.
     Parameters:
-        data: pointer to the array that will store the data
-        size: pointer to the variable that will store the size of the data array
+        moves: pointer to the moves that will store the angle steps
+        peaks: pointer to the peak events of the recording
+        features: pointer to the feature vector of the gesture
+        trace: pointer to the trace that will store the angular rates
+        stream: pointer to the keys fed the trace as it is recorded, NULL to record without matching
         timeoutAct: boolean that determines if the timeout is active
+        preTrigger: boolean that records the history from before a motion trigger first
     Returns:
         None
     */
 
    //variables
-    *size = 0;
-    xPosition = 0;
-    yPosition = 0;
-    zPosition = 0;
+    moves->clear();
+    peaks->clear();
+    trace->clear();
+    if(stream != NULL){
+        stream->start(gyro.rawRate(matchThreshold), indexSlots, 0); //nothing is accepted until the index is asked
+        streamStart = stream->getShortest() - matchBand;
+        if(streamStart < 1){
+            streamStart = 1;
+        }
+    }
     buttonStatus = notPress; //reset button status
-    gyro.center(); //centers the gyro to avoid unsynced data
-    timeoutTimer.reset(); //reset timeout timer
-    timeoutTimer.start(); //start timeout timer
 
-    while (*size < maxRecording)
+    disarmMotion(); //the recording uses the gyro samples
+    gyro.setProfile(recordProfile); //full rate while recording
+    spikeFilter.reset();
+    noiseFilter.setLowpass(gyro.getProfile().rate, noiseCutoff);
+    noiseFilter.reset();
+    pipeline.reset();
+    plotColumn = 0;
+    angles.setSensitivity(gyro.getProfile().sensitivity);
+    angles.setBias(biasFraction[0], biasFraction[1], biasFraction[2]);
+    angles.reset();
+    peaks->setThresholds(gyro.rawRate(peak_onset_mdps), gyro.getProfile().resetTrigger);
+    featureWindow.reset();
+    segmenter.reset();
+    segmenter.setThresholds(gyro.rawRate(onset_rate_mdps), gyro.rawRate(offset_rate_mdps));
+    sampleRing.flush(); //drop samples taken before the recording started
+    sampleRing.resetStats();
+    recordingStats.samples = 0;
+    mbed_stats_cpu_get(&cpuStart);
+    events.clear(samplesFlag | buttonFlag | timeoutFlag | motionFlag); //forget events from before the recording
+    if(timeoutAct){
+        recordTimeout.attach(&timeoutEvent, std::chrono::microseconds(timeoutTime));
+    }
+
+    if(preTrigger){
+        //the motion that started the recording came just before it
+        recordHistory(moves, peaks, trace, stream);
+    }
+
+    while (1)
     {
-        gyro.updatePosition(); //update gyro position
-        //check if the position has changed in any 3 axis
-        if( (gyro.getYPosition() != yPosition) || 
-                (gyro.getXPosition() != xPosition) || 
-                (gyro.getZPosition() != zPosition))
-            {
-                //update last position variables
-                yPosition = gyro.getYPosition();
-                xPosition = gyro.getXPosition();
-                zPosition = gyro.getZPosition();
-                //store position in data array
-                data[*size][0] = xPosition;
-                data[*size][1] = yPosition;
-                data[*size][2] = zPosition;
-                (*size)++;
+        //sleep until samples are waiting, the button is pressed or the timeout expires
+        uint32_t flags = events.wait_any(samplesFlag | buttonFlag | timeoutFlag);
+
+        int count;
+        while ((count = sampleRing.pop(batch, batchSize)) > 0){
+            for (int i = 0; i < count; i++){
+                measureSample(batch[i]);
+                recordSample(batch[i], moves, peaks, trace, stream);
             }
+        }
         
+        //checks if the gesture is over
+        if(segmenter.isDone()){
+            break;
+        }
+        //checks if the password was accepted before the end of the recording
+        if((stream != NULL) && (stream->getAccepted() != no_slot)){
+            break;
+        }
         //checks if the button has been pressed
-        if((buttonStatus == longPress) || (buttonStatus == shortPress)){
+        if(flags & buttonFlag){
             buttonStatus = notPress;
-            timeoutTimer.stop(); //stop timeout timer, to avoid runaway timer
             break;
         }
-        //checks if the timeout has been reached and if it is active
-        if((timeoutTimer.elapsed_time().count() > timeoutTime) && timeoutAct){
-            timeoutTimer.stop();
+        //checks if the timeout has been reached
+        if(flags & timeoutFlag){
             break;
         }
     }
-    timeoutTimer.stop(); //stop timer in case maxRecording was reached
+    recordTimeout.detach(); //stop the timeout in case the recording ended before it
+    peaks->finish(); //store the peaks cut off by the end of the recording
+    featureWindow.finish(features); //pool the window statistics of the gesture
+    gyro.setProfile(idleProfile); //back to the low rate
+    printStats();
+}
+
+void enrollKey(int slot, bool timeoutAct){
+    /*
+    Function records a key enrollRepetitions times and merges the recordings into one key template with DTW
+    barycenter averaging, along with the tolerance of each template point. The template is stored in the key slot,
+    where its envelope is built, so a password is checked with a single comparison per key, and added to the key
+    index. Each recording keeps its own moves, peak events and feature vector, the key takes the moves and peak events
+    of the recording closest to the others and the mean of the feature vectors. The time taken by the averaging is
+    printed.
+    Parameters:
+        slot: key slot of the user
+        timeoutAct: boolean that determines if the timeout is active for each recording
+    Returns:
+        None
+    */
+    keys->erase(slot);
+    keyIndex->remove(slot);
+    for (int i = 0; i < enrollRepetitions; i++){
+        updateLCD(EnterKey);
+        printf("key %d recording %d/%d\n", slot, i + 1, enrollRepetitions);
+        recordGyro(&keyMoves[i], &keyPeaks[i], &keyFeatures[i], &keyRecordings[i], NULL, timeoutAct, false);
+        thread_sleep_for(500);
+    }
+
+    unsigned int start = us_ticker_read();
+    int merged = averager.average(keyRecordings, enrollRepetitions, keys->getTrace(slot), keys->getTolerance(slot));
+    keys->enroll(slot, keyMoves, keyPeaks, keyFeatures, enrollRepetitions);
+    keyIndex->insert(slot, *keys->getTrace(slot));
+    printf("key %d template: %d points from %d recordings in %u us\n",
+        slot, keys->getTrace(slot)->getSize(), merged, us_ticker_read() - start);
+}
+
+void recordSample(const Gyro::Sample &sample, Moves::Moves *moves, Peaks::Peaks *peaks, Trace::Trace *trace, Keys::Keys *stream){
+    /*
+    Function filters one sample, removing single sample spikes with a median of 3 and noise with a low pass, then
+    integrates it into the angle of each axis and adds every angle step it reached to the moves. During the gesture
+    the peak detectors run on it too and it slides the window of the feature statistics.
+    The sample also goes through the pipeline: samples of the matching stream during the gesture are added to the
+    trace, and each new trace point is streamed to the keys closest to it, samples of the display stream are drawn on the live
+    graph. The pause that ended the gesture is trimmed off the trace, less what the matching stream did not give
+    yet. Moves past max_moves are not stored.
+    Parameters:
+        sample: the sample to record
+        moves: pointer to the moves that will store the angle steps
+        peaks: pointer to the peak events of the recording
+        trace: pointer to the trace that will store the angular rates
+        stream: pointer to the keys fed the new trace points, NULL to record without matching
+    Returns:
+        None
+    */
+    Gyro::Sample filtered = sample;
+    spikeFilter.apply(&filtered);
+    noiseFilter.apply(&filtered);
+    int outputs = pipeline.add(filtered);
+    if(segmenter.add(filtered) == Segmenter::segment_offset){
+        trace->trim(segmenter.getHold() - pipeline.getDelay()); //drop the pause that ended the gesture
+    }
+    else if(segmenter.isActive() && (outputs & Pipeline::output_match) && trace->add(pipeline.getMatch()) && (stream != NULL)){
+        streamPoint(trace, stream);
+    }
+    if(outputs & Pipeline::output_display){
+        plotSample(pipeline.getDisplay());
+    }
+    if(segmenter.isActive()){
+        peaks->add(filtered); //detect the peaks
+        featureWindow.add(filtered); //update the window statistics
+    }
+    angles.add(filtered); //integrate the angles
+    char x, y, z;
+    while(angles.step(&x, &y, &z)){
+        moves->add(x, y, z); //store the step in the moves
+    }
+}
+
+void recordHistory(Moves::Moves *moves, Peaks::Peaks *peaks, Trace::Trace *trace, Keys::Keys *stream){
+    /*
+    Function records the history from before the motion trigger. The history was taken at the idle data rate while
+    every stage of the recording is tuned for the recording rate, so it is brought up to the recording rate first:
+    the samples between two history samples are interpolated on a straight line, times included. The history is
+    not counted in the recording statistics, its samples were not read by the acquisition thread.
+    Parameters:
+        moves: pointer to the moves that will store the angle steps
+        peaks: pointer to the peak events of the recording
+        trace: pointer to the trace that will store the angular rates
+        stream: pointer to the keys fed the new trace points, NULL to record without matching
+    Returns:
+        None
+    */
+    if(historySize == 0){
+        return;
+    }
+    int factor = (historyRate > 0) ? gyro.getProfile().rate / historyRate : 1;
+    if(factor < 1){
+        factor = 1;
+    }
+    recordSample(history[0], moves, peaks, trace, stream);
+    for (int i = 1; i < historySize; i++){
+        const Gyro::Sample &from = history[i - 1];
+        const Gyro::Sample &to = history[i];
+        for (int k = 1; k <= factor; k++){
+            Gyro::Sample sample = to;
+            sample.x = (short int)(from.x + (to.x - from.x) * k / factor);
+            sample.y = (short int)(from.y + (to.y - from.y) * k / factor);
+            sample.z = (short int)(from.z + (to.z - from.z) * k / factor);
+            sample.time = from.time + (to.time - from.time) * k / factor;
+            recordSample(sample, moves, peaks, trace, stream);
+        }
+    }
+}
+
+void streamPoint(Trace::Trace *trace, Keys::Keys *stream){
+    /*
+    Function streams the last trace point to the keys closest to the password. A streamed key can not accept a
+    password shorter than it by more than matchBand points, so until the trace is that long no point is streamed.
+    Then the key index is asked once for the matchCandidates keys closest to the trace so far, the password is
+    streamed to those keys only, and the points recorded until then are given to them first. The streaming match
+    only ends the recording early, every key is still checked by checkPassword(), so a genuine key the index ranked
+    further away only lets the recording run to the end of the gesture.
+    Parameters:
+        trace: pointer to the trace of the password, with the new point last
+        stream: pointer to the keys fed the trace points
+    Returns:
+        None
+    */
+    if(streamStart == 0){
+        stream->push(trace->last());
+        return;
+    }
+    if(trace->getSize() < streamStart){
+        return;
+    }
+    int count = keyIndex->nearest(*trace, matchCandidates, indexSlots, indexDistances);
+    stream->start(gyro.rawRate(matchThreshold), indexSlots, count);
+    streamStart = 0;
+    for (int i = 0; i < trace->getSize(); i++){
+        stream->push((*trace)[i]);
+    }
+}
+
+void measureSample(const Gyro::Sample &sample){
+    /*
+    Function adds a recorded sample to the recording statistics. The latency is measured against the time the
+    gyro interrupt stamped on the sample.
+    Parameters:
+        sample: the sample being recorded
+    Returns:
+        None
+    */
+    unsigned int latency = us_ticker_read() - sample.time;
+    if(recordingStats.samples == 0){
+        recordingStats.firstTime = sample.time;
+        recordingStats.firstSequence = sample.sequence;
+        recordingStats.maxLatency = 0;
+    }
+    recordingStats.lastTime = sample.time;
+    recordingStats.lastSequence = sample.sequence;
+    if(latency > recordingStats.maxLatency){
+        recordingStats.maxLatency = latency;
+    }
+    recordingStats.samples++;
+}
+
+void printStats(void){
+    /*
+    Function prints the statistics of the last recording: the sample rate measured from the sample timestamps,
+    the samples lost according to the sequence numbers, the longest latency, the sample ring usage and the
+    share of time the cpu was busy, which is kept in the recording statistics.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    unsigned int span = recordingStats.lastTime - recordingStats.firstTime; //unsigned, survives timer wrap
+    if((recordingStats.samples > 1) && (span > 0)){
+        unsigned int expected = recordingStats.lastSequence - recordingStats.firstSequence + 1;
+        if(expected < recordingStats.samples){
+            expected = recordingStats.samples; //numbers out of order, no loss can be told
+        }
+        printf("samples: %u  rate: %u Hz  lost: %u  max latency: %u us\n",
+            recordingStats.samples,
+            (unsigned int)((unsigned long long)(recordingStats.samples - 1) * 1000000 / span),
+            expected - recordingStats.samples,
+            recordingStats.maxLatency);
+    }
+    printf("ring overruns: %u  high watermark: %u/%u\n",
+        sampleRing.getOverruns(), sampleRing.getHighWatermark(), sampleRing.getCapacity());
+
+    //share of the recording the cpu was awake, the rest was spent in the idle thread sleeping
+    mbed_stats_cpu_t cpuEnd;
+    mbed_stats_cpu_get(&cpuEnd);
+    uint64_t uptime = cpuEnd.uptime - cpuStart.uptime;
+    uint64_t idle = cpuEnd.idle_time - cpuStart.idle_time;
+    recordingStats.cpuBusy = (uptime > 0) ? (unsigned int)((uptime - idle) * 100 / uptime) : 0;
+    printf("cpu busy: %u%%\n", recordingStats.cpuBusy);
+}
+
+void watchMotion(void){
+    /*
+    Function run by the acquisition thread while the device is locked. Reading every sample is stopped, the gyro fifo
+    keeps the latest samples and the gyro motion interrupt is armed, so the core sleeps until the device is moved.
+    On motion, the fifo contents are kept as the history from just before the motion, along with the data rate they
+    were taken at, and the main thread is woken to start a password attempt, which records the history ahead of the
+    samples in the ring.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    bool moved = false;
+
+    gyro.disableDataReady();
+    gyro.enableFifo(0);
+    gyro.enableMotionWake(motionTrigger);
+    while(motionArmed && !moved){
+        moved = gyro.waitMotion(osWaitForever); //false when disarmed
+    }
+    gyro.disableMotionWake();
+
+    if(moved){
+        historySize = gyro.readFifo(history, fifo_depth);
+        historyRate = gyro.getProfile().rate;
+        motionArmed = false;
+        events.set(motionFlag); //hands the history over to the main thread
+    }
+    gyro.disableFifo();
+    gyro.enableDataReady();
+}
+
+void armMotion(void){
+    /*
+    Function asks the acquisition thread to sleep until the gyro detects motion.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    motionArmed = true;
+}
+
+void disarmMotion(void){
+    /*
+    Function asks the acquisition thread to go back to reading every sample.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    motionArmed = false;
+    gyro.cancelMotion();
+}
+
+void trackBias(Bias::Bias *tracker, const Gyro::Sample &sample){
+    /*
+    Function keeps the gyro bias calibrated while the device is still.
+    Samples already have the bias removed, so whenever a full window was still
+    and its mean is within the still threshold, that mean is the drift of the
+    bias since the last correction. The fraction of a raw unit below the mean
+    is kept for the angle integration.
+    Parameters:
+        tracker: running statistics of the current window
+        sample: the newest sample
+    Returns:
+        None
+    */
+    if(!tracker->add(sample)){
+        return;
+    }
+    short int threshold = gyro.rawRate(still_rate_mdps);
+    tracker->setStillThreshold(threshold);
+    if(tracker->isStill() &&
+        (abs(tracker->getX()) <= threshold) &&
+        (abs(tracker->getY()) <= threshold) &&
+        (abs(tracker->getZ()) <= threshold))
+    {
+        gyro.adjustBias(tracker->getX(), tracker->getY(), tracker->getZ());
+        biasFraction[0] = tracker->getFractionX();
+        biasFraction[1] = tracker->getFractionY();
+        biasFraction[2] = tracker->getFractionZ();
+    }
+}
+
+void acquireGyro(void){
+    /*
+    Thread function that reads every gyro sample when the gyro signals it on its
+    data ready interrupt and pushes it into the sample ring. This decouples the
+    800Hz gyro rate from the recording and matching code, which drains the ring
+    in batches. Samples that do not fit in the ring are counted as overruns.
+    The samples also feed the bias tracker. While motion is armed the thread sleeps in watchMotion() instead.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    Gyro::Sample sample;
+    Bias::Bias biasTracker(bias_window_shift);
+    gyro.enableDataReady();
+    while(1){
+        if(motionArmed){
+            watchMotion();
+            continue;
+        }
+        if(gyro.readSample(&sample, sampleTimeout)){
+            sampleRing.push(sample);
+            if(sampleRing.size() >= wakeSamples){
+                events.set(samplesFlag); //wake the recording once per batch, not per sample
+            }
+            trackBias(&biasTracker, sample);
+        }
+    }
 }
 
 void updateLCD(LCDState lcdState){
@@ -350,6 +889,40 @@ void updateLCD(LCDState lcdState){
     lcd.DisplayStringAt(0, LINE(10), (uint8_t *)display_buf[0], CENTER_MODE);
 }
 
+void plotSample(const Gyro::Sample &sample){
+    /*
+    Function draws one sample of the display stream on the live graph below the text, x in red, y in green and z
+    in blue, full scale from the bottom to the top of the graph. The graph scrolls by one column per sample and
+    wraps around at the right edge, clearing each column before drawing in it.
+    Parameters:
+        sample: the display sample
+    Returns:
+        None
+    */
+    uint32_t top = LINE(12);
+    uint32_t bottom = lcd.GetYSize() - GRAPH_PADDING - 2;
+    uint32_t middle = (top + bottom) / 2;
+    int half = (bottom - top) / 2;
+    uint32_t x = GRAPH_PADDING + 1 + plotColumn;
+    const short int values[3] = {sample.x, sample.y, sample.z};
+    const uint32_t colors[3] = {LCD_COLOR_RED, LCD_COLOR_GREEN, LCD_COLOR_BLUE};
+
+    lcd.SetTextColor(LCD_COLOR_BLACK);
+    lcd.DrawVLine(x, top, bottom - top + 1);
+    for(int axis = 0; axis < 3; axis++){
+        uint32_t y = middle - values[axis] * half / 32768;
+        lcd.SetTextColor(colors[axis]);
+        if(plotColumn == 0){
+            lcd.DrawPixel(x, y, colors[axis]);
+        }
+        else{
+            lcd.DrawLine(x - 1, plotLast[axis], x, y);
+        }
+        plotLast[axis] = y;
+    }
+    plotColumn = (plotColumn + 1 < graph_width - 2) ? plotColumn + 1 : 0;
+}
+
 //--------------------------------------------Main Function--------------------------------------------
 
 int main()
@@ -359,14 +932,17 @@ int main()
     button.rise(&raiseEvent);
     button.fall(&fallEvent);
 
-    //initializes the gyro
+    //initializes the gyro and starts reading it
     gyro.init();
+    gyro.setProfile(idleProfile);
+    pipeline.configure(trace_decimation, displayFactor);
+    acquisitionThread.start(acquireGyro);
 
     //initializes the status of the device
     //a key needs to be recorded as part of the initialization
     status = unlocked;
-    updateLCD(EnterKey);
-    recordGyro(key, &keySize, false);
+    activeSlot = 0;
+    enrollKey(activeSlot, false);
     //displays the key stored message
     updateLCD(KeyStored);
     thread_sleep_for(1500);
@@ -375,27 +951,49 @@ int main()
     //sets the status to locked
     status = locked;
 
+    //events that woke the main thread
+    uint32_t wakeFlags = 0;
+
     while(1){
+        //motion while locked starts a password attempt like a short press
+        bool motionStart = (wakeFlags & motionFlag) && (buttonStatus == notPress);
 
-        if((buttonStatus == longPress) && (status == locked)){
+        if(((buttonStatus == longPress) || (buttonStatus == addKeyPress)) && (status == locked)){
             //display error: cant record new key while locked
             updateLCD(NoKeyAllowed);
             thread_sleep_for(1500);
             updateLCD(Locked);
         }
         else if((buttonStatus == longPress) && (status == unlocked)){
-            // record new key
-            updateLCD(EnterKey);
-            recordGyro(key, &keySize, true);
+            // record new key for the active user
+            enrollKey(activeSlot, true);
             updateLCD(KeyStored);
             thread_sleep_for(1500);
             updateLCD(Locked);
             status = locked;
         }
-        else if((buttonStatus == shortPress) && (status == locked)){
-            // enter password
+        else if((buttonStatus == addKeyPress) && (status == unlocked)){
+            // record the key of a new user in a free slot
+            int slot = keys->getFree();
+            if(slot == no_slot){
+                //display error: every key slot is used
+                updateLCD(NoKeyAllowed);
+                thread_sleep_for(1500);
+                updateLCD(Unlocked);
+            }
+            else{
+                enrollKey(slot, true);
+                activeSlot = slot;
+                updateLCD(KeyStored);
+                thread_sleep_for(1500);
+                updateLCD(Locked);
+                status = locked;
+            }
+        }
+        else if(((buttonStatus == shortPress) || motionStart) && (status == locked)){
+            // enter password, keeping the samples from before the motion if it started the attempt
             updateLCD(EnterPassword);
-            recordGyro(recordings, &recordingSize, true);
+            recordGyro(&passwordMoves, &passwordPeaks, &passwordFeatures, &passwordTrace, keys, true, motionStart);
 
             if(checkPassword()){
                 updateLCD(CorrectPassword);
@@ -420,7 +1018,16 @@ int main()
             buttonStatus = notPress;
         }
 
-        thread_sleep_for(1);
+        //while locked, let the gyro wake the device on motion
+        if(status == locked){
+            armMotion();
+        }
+        else{
+            disarmMotion();
+        }
+
+        //sleep until the button is pressed again or the device is moved while locked
+        wakeFlags = events.wait_any(buttonFlag | motionFlag);
 
        
 }
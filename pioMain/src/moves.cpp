@@ -0,0 +1,71 @@
+#include "moves.h"
+
+// Moves constructor, starts empty
+Moves::Moves::Moves(){
+    clear();
+}
+
+// Moves public methods
+void Moves::Moves::clear(){
+    /*
+    Method used to empty the sequence.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    for(int i = 0; i < move_words; i++){
+        words[i] = 0;
+    }
+    size = 0;
+}
+
+bool Moves::Moves::add(char x, char y, char z){
+    /*
+    Method used to append a move, ignored once the sequence is full.
+
+    Parameters:
+        x: x position, 0 to 2
+        y: y position, 0 to 2
+        z: z position, 0 to 2
+    Returns:
+        true if the move was appended
+    */
+    if(size >= max_moves){
+        return false;
+    }
+    uint32_t move = (x & 3) | ((y & 3) << 2) | ((z & 3) << 4);
+    words[size / moves_per_word] |= move << ((size % moves_per_word) * move_bits);
+    size++;
+    return true;
+}
+
+char Moves::Moves::getMove(int i) const {
+    /*
+    Method used to read a move.
+
+    Parameters:
+        i: index of the move
+    Returns:
+        the move, x in bits 0-1, y in bits 2-3 and z in bits 4-5
+    */
+    return (char)((words[i / moves_per_word] >> ((i % moves_per_word) * move_bits)) & 0x3F);
+}
+
+int Moves::Moves::distance(const Moves &other) const {
+    /*
+    Method used to count the bits that differ between two sequences.
+
+    Parameters:
+        other: the sequence to compare with
+    Returns:
+        number of differing bits, 0 if the sequences are equal
+    */
+    int longest = (size > other.size) ? size : other.size;
+    int count = 0;
+    for(int i = 0; i < (longest + moves_per_word - 1) / moves_per_word; i++){
+        count += __builtin_popcount(words[i] ^ other.words[i]);
+    }
+    return count;
+}
@@ -0,0 +1,49 @@
+/*
+Moves Class
+
+This class stores the sequence of moves of a recording packed into words.
+Each move is an angle step or position of x, y and z (none or centered 0,
+positive 1, negative 2) in 2 bits each, so 6 bits per move and 5 moves per
+32 bit word.
+A 256 move recording fits in 52 words.
+
+Two sequences are compared a word at a time: the set bits of the XOR of the
+words are the bits that differ, counted with popcount. Moves missing from
+the shorter sequence compare as centered. A move that differs has at least
+one differing bit, so the count plus the length difference is never below
+the edit distance, and sequences within a limit by the count skip the edit
+distance.
+
+*/
+
+// safeguards
+#ifndef moves_h
+#define moves_h
+
+#include <stdint.h>
+
+// moves values
+#define max_moves 256 // moves stored per recording
+#define move_bits 6 // 2 bits per axis
+#define moves_per_word 5
+#define move_words ((max_moves + moves_per_word - 1) / moves_per_word)
+
+namespace Moves{
+
+    class Moves{
+        public:
+            // constructor
+            Moves();
+            // public methods
+            void clear();
+            bool add(char x, char y, char z);
+            char getMove(int i) const;
+            int distance(const Moves &other) const;
+            int getSize() const {return size;}
+        private:
+            uint32_t words[move_words];
+            int size;
+    };
+}
+
+#endif
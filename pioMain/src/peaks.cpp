@@ -0,0 +1,163 @@
+#include "peaks.h"
+#include <cstdlib>
+#include <climits>
+
+// Peaks constructor, starts empty
+Peaks::Peaks::Peaks(){
+    setThresholds(SHRT_MAX, 0);
+    clear();
+}
+
+// Peaks public methods
+void Peaks::Peaks::clear(){
+    /*
+    Method used to empty the list and stop every peak going on.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    size = 0;
+    for(int axis = 0; axis < 3; axis++){
+        active[axis] = false;
+        negative[axis] = false;
+        peak[axis] = 0;
+        start[axis] = 0;
+        last[axis] = 0;
+    }
+}
+
+void Peaks::Peaks::setThresholds(short int onset, short int reset){
+    /*
+    Method used to set the thresholds of the detectors. The reset threshold
+    must be below the onset one.
+
+    Parameters:
+        onset: rate that starts a peak in raw units
+        reset: rate below which a peak ends in raw units
+    Returns:
+        None
+    */
+    this->onset = (onset > 0) ? onset : 1;
+    this->reset = reset;
+}
+
+void Peaks::Peaks::add(const Gyro::Sample &sample){
+    /*
+    Method used to run the detector of every axis on a sample. A peak that
+    ends is added to the list, peaks past peak_max_events are not stored.
+
+    Parameters:
+        sample: the next sample
+    Returns:
+        None
+    */
+    const short int values[3] = {sample.x, sample.y, sample.z};
+    for(int axis = 0; axis < 3; axis++){
+        int magnitude = abs(values[axis]);
+        if(!active[axis]){
+            if(magnitude > onset){
+                active[axis] = true;
+                negative[axis] = values[axis] < 0;
+                peak[axis] = (short int)((magnitude > SHRT_MAX) ? SHRT_MAX : magnitude);
+                start[axis] = sample.time;
+                last[axis] = sample.time;
+            }
+            continue;
+        }
+        if((magnitude < reset) || ((values[axis] < 0) != negative[axis])){
+            store(axis);
+            continue;
+        }
+        if(magnitude > peak[axis]){
+            peak[axis] = (short int)((magnitude > SHRT_MAX) ? SHRT_MAX : magnitude);
+        }
+        last[axis] = sample.time;
+    }
+}
+
+void Peaks::Peaks::finish(){
+    /*
+    Method used to end the peaks still going on when the recording stops.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    for(int axis = 0; axis < 3; axis++){
+        if(active[axis]){
+            store(axis);
+        }
+    }
+}
+
+int Peaks::Peaks::distance(const Peaks &other, int maxDistance) const {
+    /*
+    Method used to find the edit distance of two lists, one row at a time.
+    The comparison stops once every entry of a row is over maxDistance.
+
+    Parameters:
+        other: the list to compare with
+        maxDistance: largest distance of interest
+    Returns:
+        the distance, maxDistance + 1 if it is larger
+    */
+    int row[peak_max_events + 1];
+    int n = other.size;
+    for(int j = 0; j <= n; j++){
+        row[j] = j * peak_gap_cost;
+    }
+    for(int i = 0; i < size; i++){
+        unsigned char event = events[i];
+        int diagonal = row[0];
+        row[0] = (i + 1) * peak_gap_cost;
+        int lowest = row[0];
+        for(int j = 1; j <= n; j++){
+            unsigned char match = other.events[j - 1];
+            int cost = 2 * peak_gap_cost;
+            if(((event ^ match) & (peak_axis_mask | peak_sign_bit)) == 0){
+                cost = abs(((event >> peak_amplitude_shift) & 3) - ((match >> peak_amplitude_shift) & 3)) +
+                    abs(((event >> peak_duration_shift) & 3) - ((match >> peak_duration_shift) & 3));
+            }
+            int best = diagonal + cost;
+            if(row[j] + peak_gap_cost < best){best = row[j] + peak_gap_cost;}
+            if(row[j - 1] + peak_gap_cost < best){best = row[j - 1] + peak_gap_cost;}
+            diagonal = row[j];
+            row[j] = best;
+            if(best < lowest){lowest = best;}
+        }
+        if(lowest > maxDistance){
+            return maxDistance + 1;
+        }
+    }
+    return (row[n] > maxDistance) ? maxDistance + 1 : row[n];
+}
+
+// Peaks private methods
+void Peaks::Peaks::store(int axis){
+    /*
+    Method used to end the peak of an axis and add it to the list.
+
+    Parameters:
+        axis: 0 for x, 1 for y, 2 for z
+    Returns:
+        None
+    */
+    active[axis] = false;
+    if(size >= peak_max_events){
+        return;
+    }
+    int amplitude = 2 * peak[axis] / onset - 2;
+    if(amplitude < 0){amplitude = 0;}
+    if(amplitude > peak_buckets - 1){amplitude = peak_buckets - 1;}
+    unsigned int length = last[axis] - start[axis];
+    int duration = 0;
+    while((duration < peak_buckets - 1) && (length >= ((unsigned int)peak_duration_unit << duration))){
+        duration++;
+    }
+    events[size] = (unsigned char)(axis | (negative[axis] ? peak_sign_bit : 0) |
+        (amplitude << peak_amplitude_shift) | (duration << peak_duration_shift));
+    size++;
+}
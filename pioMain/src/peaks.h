@@ -0,0 +1,71 @@
+/*
+Peaks Class
+
+This class turns the gyro samples of a recording into a short list of peak
+events. Each axis has its own detector with hysteresis: a peak starts when
+the rate goes above the onset threshold in either direction and ends once it
+falls back below the reset threshold, the reset_trigger of the gyro profile.
+While a peak lasts only its highest rate and its start time are kept, so the
+work per sample is constant.
+
+When a peak ends it is stored as one byte:
+    -bits 0-1: axis, 0 for x, 1 for y, 2 for z
+    -bit 2: sign, 1 when the rate was negative
+    -bits 3-4: amplitude bucket, the highest rate in steps of half the onset
+    -bits 5-6: duration bucket, doubling from peak_duration_unit
+
+Two lists are compared with an edit distance where a missing or extra event
+costs peak_gap_cost and two events on the same axis and sign cost the
+difference of their buckets, so a peak that was a little stronger or longer
+costs less than a different one.
+
+*/
+
+// safeguards
+#ifndef peaks_h
+#define peaks_h
+
+#include "gyro.h"
+
+// peaks values
+#define peak_max_events 16 // events stored per recording, the gestures of the recordings give up to 9
+#define peak_onset_mdps 87500 // rate that starts a peak in millidegrees per second
+#define peak_duration_unit 80000 // microseconds, longest peak in the first duration bucket
+#define peak_buckets 4 // amplitude and duration buckets
+#define peak_gap_cost 4 // cost of a missing or extra event
+#define peak_axis_mask 0x03
+#define peak_sign_bit 0x04
+#define peak_amplitude_shift 3
+#define peak_duration_shift 5
+
+namespace Peaks{
+
+    class Peaks{
+        public:
+            // constructor
+            Peaks();
+            // public methods
+            void clear();
+            void setThresholds(short int onset, short int reset);
+            void add(const Gyro::Sample &sample);
+            void finish();
+            int distance(const Peaks &other, int maxDistance) const;
+            unsigned char getEvent(int i) const {return events[i];}
+            int getSize() const {return size;}
+        private:
+            // private methods
+            void store(int axis);
+            // private variables
+            unsigned char events[peak_max_events];
+            int size;
+            short int onset;
+            short int reset;
+            bool active[3]; // a peak is going on
+            bool negative[3]; // sign of the peak going on
+            short int peak[3]; // highest magnitude of the peak going on
+            unsigned int start[3]; // time the peak started
+            unsigned int last[3]; // time of the last sample above the reset threshold
+    };
+}
+
+#endif
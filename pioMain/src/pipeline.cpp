@@ -0,0 +1,98 @@
+#include "pipeline.h"
+
+// finds n such that 1 << n is value, -1 if value is not a power of two
+static int powerOfTwo(int value){
+    for(int n = 0; n < 31; n++){
+        if(value == (1 << n)){
+            return n;
+        }
+    }
+    return -1;
+}
+
+// Pipeline constructor, matching at a sixteenth and display at a quarter of that
+Pipeline::Pipeline::Pipeline(){
+    configure(16, 4);
+}
+
+// Pipeline public methods
+bool Pipeline::Pipeline::configure(int matchFactor, int displayFactor){
+    /*
+    Method used to set the decimation of both streams. Both factors must be
+    powers of two so the comb gains are shifts, and the matching factor must
+    be at least 2 for the FIR.
+
+    Parameters:
+        matchFactor: sensor samples per matching sample
+        displayFactor: matching samples per display sample
+    Returns:
+        true if the streams were set, false if a factor is not allowed
+    */
+    int matchShift = powerOfTwo(matchFactor);
+    int displayShift = powerOfTwo(displayFactor);
+    if((matchShift < 1) || (displayShift < 0)){
+        return false;
+    }
+    if(!matchComb.configure(match_cic_order, matchShift - 1) || !displayComb.configure(display_cic_order, displayShift)){
+        return false;
+    }
+    matchFir.setLowpass(match_fir_taps, 2);
+    this->matchFactor = matchFactor;
+    this->displayFactor = displayFactor;
+    reset();
+    return true;
+}
+
+void Pipeline::Pipeline::reset(){
+    /*
+    Method used to clear every stage, for example before a new recording.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    matchComb.reset();
+    matchFir.reset();
+    displayComb.reset();
+    combed = Gyro::Sample();
+    match = Gyro::Sample();
+    display = Gyro::Sample();
+}
+
+int Pipeline::Pipeline::add(const Gyro::Sample &sample){
+    /*
+    Method used to feed a sensor sample through the stages. The new stream
+    samples are read with getMatch() and getDisplay().
+
+    Parameters:
+        sample: the sensor sample
+    Returns:
+        the Output flags of the streams that got a new sample
+    */
+    int outputs = output_none;
+    if(!matchComb.decimate(sample, &combed)){
+        return outputs;
+    }
+    if(!matchFir.decimate(combed, &match)){
+        return outputs;
+    }
+    outputs |= output_match;
+    if(displayComb.decimate(match, &display)){
+        outputs |= output_display;
+    }
+    return outputs;
+}
+
+int Pipeline::Pipeline::getDelay(){
+    /*
+    Method used to find how far the matching stream lags the sensor, the
+    group delay of the comb and the FIR.
+
+    Parameters:
+        None
+    Returns:
+        the delay in sensor samples
+    */
+    return matchComb.getDelay() + matchFir.getDelay() * matchComb.getFactor();
+}
@@ -0,0 +1,63 @@
+/*
+Pipeline Class
+
+This class splits the gyro samples into streams at lower rates, so each
+consumer only runs as often as it needs to:
+    -the matching stream, for the trace, decimated by matchFactor
+    -the display stream, for the live graph, decimated by displayFactor more
+
+The matching stream comes out of a cascaded integrator comb decimator,
+which takes the sensor rate down to twice the matching rate with additions
+only, followed by a FIR low pass decimating by 2 that removes what the comb
+lets alias. The FIR only computes the outputs it keeps. The display stream
+is the matching stream through a second, shorter comb decimator.
+
+Every stage does a fixed amount of work per input sample and the work after
+each decimator shrinks by its factor, so at 800Hz with the default factors
+the FIR runs at 100Hz and the display at 12.5Hz.
+
+*/
+
+// safeguards
+#ifndef pipeline_h
+#define pipeline_h
+
+#include "gyro.h"
+#include "dsp.h"
+
+// pipeline values
+#define match_cic_order 3 // comb stages before the matching fir
+#define match_fir_taps 16 // taps of the matching fir, at twice the matching rate
+#define display_cic_order 2 // comb stages of the display stream
+
+namespace Pipeline{
+
+    // streams a sample gave an output to, as flags
+    enum Output{output_none = 0x00, output_match = 0x01, output_display = 0x02};
+
+    class Pipeline{
+        public:
+            // constructor
+            Pipeline();
+            // public methods
+            bool configure(int matchFactor, int displayFactor);
+            void reset();
+            int add(const Gyro::Sample &sample);
+            const Gyro::Sample &getMatch(){return match;}
+            const Gyro::Sample &getDisplay(){return display;}
+            int getMatchFactor(){return matchFactor;}
+            int getDisplayFactor(){return displayFactor;}
+            int getDelay();
+        private:
+            Dsp::Cic matchComb;
+            Dsp::Fir matchFir;
+            Dsp::Cic displayComb;
+            Gyro::Sample combed; // last output of the matching comb
+            Gyro::Sample match; // last sample of the matching stream
+            Gyro::Sample display; // last sample of the display stream
+            int matchFactor;
+            int displayFactor;
+    };
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+Gyro Profiles
+
+Table of the sensor settings the I3G4250D supports: every output data rate
+(100, 200, 400, 800Hz), the four bandwidth settings of each rate and the
+three full scale ranges (245, 500, 2000dps). The table is generated at
+compile time, each entry holds the register values to write and the
+thresholds already scaled to the raw units of that full scale, so a profile
+can be switched at runtime with three register writes and no math.
+
+The high pass filter cutoff is chosen per rate so it stays at 4Hz.
+
+*/
+
+// safeguards
+#ifndef profile_h
+#define profile_h
+
+// ctrl_reg1 fields
+#define power_on_all_axes 0x0F // PD, Zen, Yen, Xen
+#define data_rate_shift 6
+#define bandwidth_shift 4
+
+// ctrl_reg4 fields
+#define full_scale_shift 4
+
+// thresholds in millidegrees per second
+#define reset_trigger_mdps 43750
+
+namespace Gyro{
+
+    // output data rates, the value is the DR1:0 code
+    enum DataRate{odr_100hz, odr_200hz, odr_400hz, odr_800hz};
+    // bandwidth settings, the value is the BW1:0 code, the cutoff depends on the rate
+    enum Bandwidth{bw_lowest, bw_low, bw_high, bw_highest};
+    // full scale ranges, the value is the FS1:0 code
+    enum FullScale{fs_245dps, fs_500dps, fs_2000dps};
+
+    #define data_rates 4
+    #define bandwidths 4
+    #define full_scales 3
+    #define profile_count (data_rates * bandwidths * full_scales)
+
+    // one sensor configuration
+    struct Profile{
+        char ctrl1; // data rate, bandwidth, power and axes
+        char ctrl2; // high pass filter cutoff
+        char ctrl4; // full scale
+        unsigned short rate; // output data rate in Hz
+        unsigned short cutoff; // bandwidth cutoff in tenths of Hz
+        unsigned short sensitivity; // hundredths of millidegrees per second per digit
+        short int resetTrigger; // reset_trigger_mdps in raw units
+    };
+
+    struct ProfileTable{
+        Profile profiles[profile_count];
+    };
+
+    constexpr unsigned short rateHz(int rate){
+        return 100 << rate;
+    }
+
+    constexpr unsigned short cutoffTenths(int rate, int bandwidth){
+        //bandwidth cutoffs from the datasheet, rows are the data rates
+        constexpr unsigned short table[data_rates][bandwidths] = {
+            {125, 250, 250, 250},
+            {125, 250, 500, 700},
+            {200, 250, 500, 1100},
+            {300, 350, 500, 1100},
+        };
+        return table[rate][bandwidth];
+    }
+
+    constexpr unsigned short sensitivityHundredths(int scale){
+        //8.75, 17.5 and 70 millidegrees per second per digit
+        return (scale == fs_245dps) ? 875 : (scale == fs_500dps) ? 1750 : 7000;
+    }
+
+    constexpr short int toRaw(long mdps, int scale){
+        return (short int)(mdps * 100 / sensitivityHundredths(scale));
+    }
+
+    constexpr Profile makeProfile(int rate, int bandwidth, int scale){
+        return Profile{
+            (char)((rate << data_rate_shift) | (bandwidth << bandwidth_shift) | power_on_all_axes),
+            (char)(rate + 1), //4Hz high pass cutoff at every rate
+            (char)(scale << full_scale_shift),
+            rateHz(rate),
+            cutoffTenths(rate, bandwidth),
+            sensitivityHundredths(scale),
+            toRaw(reset_trigger_mdps, scale),
+        };
+    }
+
+    constexpr int profileIndex(DataRate rate, Bandwidth bandwidth, FullScale scale){
+        return (rate * bandwidths + bandwidth) * full_scales + scale;
+    }
+
+    constexpr ProfileTable makeProfileTable(){
+        ProfileTable table = {};
+        for(int rate = 0; rate < data_rates; rate++){
+            for(int bandwidth = 0; bandwidth < bandwidths; bandwidth++){
+                for(int scale = 0; scale < full_scales; scale++){
+                    table.profiles[profileIndex((DataRate)rate, (Bandwidth)bandwidth, (FullScale)scale)] =
+                        makeProfile(rate, bandwidth, scale);
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr ProfileTable profileTable = makeProfileTable();
+
+    //the settings the gyro was first written with: 800Hz, 110Hz bandwidth, 245dps
+    static_assert(profileTable.profiles[profileIndex(odr_800hz, bw_highest, fs_245dps)].ctrl1 == (char)0xFF,
+        "profile table does not match the original setup");
+    static_assert(profileTable.profiles[profileIndex(odr_800hz, bw_highest, fs_245dps)].resetTrigger == 5000,
+        "reset threshold does not match the original setup");
+}
+
+#endif
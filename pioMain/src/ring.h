@@ -0,0 +1,103 @@
+/*
+Ring Class
+
+This class is a single producer, single consumer ring buffer used to pass
+gyro samples from the acquisition thread to the code that consumes them.
+Neither side ever waits on the other: the producer only writes the head
+index and the consumer only writes the tail index, so a push or pop is a
+fixed number of steps.
+
+The capacity must be a power of two so the indexes can run freely and be
+wrapped with a mask. When the ring is full new items are dropped and counted
+as overruns. The highest fill level seen by the producer is kept as the high
+watermark so the margin left in the ring can be measured.
+
+*/
+
+// safeguards
+#ifndef ring_h
+#define ring_h
+
+#include <atomic>
+
+namespace Ring{
+
+    template <typename T, unsigned int capacity>
+    class Ring{
+        static_assert((capacity != 0) && ((capacity & (capacity - 1)) == 0), "ring capacity must be a power of two");
+
+        public:
+            Ring(): head(0), tail(0), overruns(0), highWatermark(0){}
+
+            bool push(const T &item){
+                /*
+                Method used by the producer to add one item to the ring.
+
+                Parameters:
+                    item: the item to add
+                Returns:
+                    true if the item was added, false if the ring was full
+                */
+                unsigned int h = head.load(std::memory_order_relaxed);
+                unsigned int level = h - tail.load(std::memory_order_acquire);
+                if(level >= capacity){
+                    overruns.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                items[h & (capacity - 1)] = item;
+                head.store(h + 1, std::memory_order_release);
+                if(level + 1 > highWatermark.load(std::memory_order_relaxed)){
+                    highWatermark.store(level + 1, std::memory_order_relaxed);
+                }
+                return true;
+            }
+
+            int pop(T *out, int maxItems){
+                /*
+                Method used by the consumer to take a batch of items out of the
+                ring, oldest first.
+
+                Parameters:
+                    out: array that will store the items
+                    maxItems: size of the out array
+                Returns:
+                    number of items stored in the out array
+                */
+                unsigned int t = tail.load(std::memory_order_relaxed);
+                unsigned int level = head.load(std::memory_order_acquire) - t;
+                int count = (level < (unsigned int)maxItems) ? (int)level : maxItems;
+                for(int i = 0; i < count; i++){
+                    out[i] = items[(t + i) & (capacity - 1)];
+                }
+                tail.store(t + count, std::memory_order_release);
+                return count;
+            }
+
+            void flush(){
+                /*
+                Method used by the consumer to discard every item in the ring.
+
+                Parameters:
+                    None
+                Returns:
+                    None
+                */
+                tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+            }
+
+            unsigned int size(){return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);}
+            unsigned int getCapacity(){return capacity;}
+            unsigned int getOverruns(){return overruns.load(std::memory_order_relaxed);}
+            unsigned int getHighWatermark(){return highWatermark.load(std::memory_order_relaxed);}
+            void resetStats(){overruns.store(0, std::memory_order_relaxed); highWatermark.store(0, std::memory_order_relaxed);}
+
+        private:
+            T items[capacity];
+            std::atomic<unsigned int> head; // written by the producer only
+            std::atomic<unsigned int> tail; // written by the consumer only
+            std::atomic<unsigned int> overruns;
+            std::atomic<unsigned int> highWatermark;
+    };
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "sax.h"
+#include <cmath>
+
+// Sax constructor
+Sax::Sax::Sax(int alphabet, short int scale){
+    setAlphabet(alphabet, scale);
+}
+
+// Sax public methods
+void Sax::Sax::setAlphabet(int alphabet, short int scale){
+    /*
+    Method used to cut the symbols of the alphabet. Breakpoint k is the value
+    below which k of every alphabet values of a normal distribution fall,
+    found by bisection of the normal distribution. Words encoded before the
+    alphabet changes can not be compared with the new ones.
+
+    Parameters:
+        alphabet: symbols per axis, from 2 to sax_alphabet_max
+        scale: standard deviation of the normal distribution in raw units
+    Returns:
+        None
+    */
+    if(alphabet < 2){alphabet = 2;}
+    if(alphabet > sax_alphabet_max){alphabet = sax_alphabet_max;}
+    this->alphabet = alphabet;
+
+    for(int k = 1; k < alphabet; k++){
+        float target = (float)k / alphabet;
+        float low = -8.0f;
+        float high = 8.0f;
+        for(int i = 0; i < 32; i++){
+            float middle = (low + high) / 2;
+            if(0.5f * erfcf(-middle / sqrtf(2.0f)) < target){
+                low = middle;
+            }
+            else{
+                high = middle;
+            }
+        }
+        breakpoints[k - 1] = (int)lroundf((low + high) / 2 * scale);
+    }
+
+    for(int row = 0; row < sax_alphabet_max; row++){
+        for(int column = 0; column < sax_alphabet_max; column++){
+            gaps[row][column] = 0;
+            if((row < alphabet) && (column < alphabet) && (row > column)){
+                gaps[row][column] = breakpoints[row - 1] - breakpoints[column];
+            }
+        }
+    }
+}
+
+void Sax::Sax::encode(const Trace::Trace &trace, Word *word){
+    /*
+    Method used to find the word of a trace, one symbol per segment of each
+    axis. The last segment may be shorter.
+
+    Parameters:
+        trace: the trace
+        word: pointer to the word that will store the symbols
+    Returns:
+        None
+    */
+    int n = trace.getSize();
+    word->points = n;
+    word->size = (n + sax_segment - 1) / sax_segment;
+    for(int s = 0; s < word->size; s++){
+        int first = s * sax_segment;
+        int last = (first + sax_segment < n) ? first + sax_segment : n;
+        int sum[3] = {0, 0, 0};
+        for(int i = first; i < last; i++){
+            sum[0] += trace[i].x;
+            sum[1] += trace[i].y;
+            sum[2] += trace[i].z;
+        }
+        for(int axis = 0; axis < 3; axis++){
+            unsigned char value = symbol(sum[axis], last - first);
+            word->symbols[s][axis] = (value << 4) | value;
+        }
+    }
+}
+
+void Sax::Sax::encode(Envelope::Envelope &envelope, Word *word){
+    /*
+    Method used to find the word of a key envelope, the symbols of the
+    averages of the lower and of the upper envelope over each segment of
+    each axis. A password point costs at least its distance beyond the
+    envelope, so a segment of the password costs at least its points times
+    the distance of its average beyond the averages of the envelope.
+
+    Parameters:
+        envelope: the key envelope
+        word: pointer to the word that will store the symbols
+    Returns:
+        None
+    */
+    int n = envelope.getSize();
+    word->points = n;
+    word->size = (n + sax_segment - 1) / sax_segment;
+    for(int s = 0; s < word->size; s++){
+        int first = s * sax_segment;
+        int last = (first + sax_segment < n) ? first + sax_segment : n;
+        for(int axis = 0; axis < 3; axis++){
+            int top = 0;
+            int bottom = 0;
+            for(int i = first; i < last; i++){
+                top += envelope.getUpper(i)[axis];
+                bottom += envelope.getLower(i)[axis];
+            }
+            word->symbols[s][axis] = (symbol(top, last - first) << 4) | symbol(bottom, last - first);
+        }
+    }
+}
+
+unsigned int Sax::Sax::minDist(const Word &a, const Word &b){
+    /*
+    Method used to find the MINDIST of two words, the gap between the symbol
+    ranges of each segment times its points. For a password word and a key
+    envelope word it is a lower bound of the LB_Keogh sum of the password,
+    so it is scaled like pointBound() sums. The averages of a segment the
+    words do not have the same points of stand for different points, so
+    the segment is left out.
+
+    Parameters:
+        a: first word
+        b: second word
+    Returns:
+        the lower bound of the distance of the traces of the words
+    */
+    int size = (a.size < b.size) ? a.size : b.size;
+    unsigned int sum = 0;
+    for(int s = 0; s < size; s++){
+        int first = s * sax_segment;
+        int points = (a.points - first < sax_segment) ? a.points - first : sax_segment;
+        if(points != ((b.points - first < sax_segment) ? b.points - first : sax_segment)){
+            continue;
+        }
+        unsigned int gap = 0;
+        for(int axis = 0; axis < 3; axis++){
+            unsigned char symbolsA = a.symbols[s][axis];
+            unsigned char symbolsB = b.symbols[s][axis];
+            //at most one of the ranges is above the other
+            gap += gaps[symbolsA & 0x0F][symbolsB >> 4] + gaps[symbolsB & 0x0F][symbolsA >> 4];
+        }
+        sum += gap * points;
+    }
+    return sum;
+}
+
+// Sax private methods
+unsigned char Sax::Sax::symbol(int sum, int count){
+    /*
+    Method used to find the symbol of the average of count values, compared
+    through the sum so the average is never rounded.
+
+    Parameters:
+        sum: sum of the values
+        count: number of values
+    Returns:
+        the symbol of the average
+    */
+    unsigned char value = 0;
+    while((value < alphabet - 1) && (breakpoints[value] * count <= sum)){
+        value++;
+    }
+    return value;
+}
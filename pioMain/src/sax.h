@@ -0,0 +1,75 @@
+/*
+Sax Class
+
+This class compresses a trace into a short symbolic word per axis with the
+symbolic aggregate approximation (SAX). The trace is cut into segments of
+sax_segment points and each segment is replaced by its average (PAA), then
+the average is replaced by the symbol of the band of values it falls in.
+The bands are cut at the quantiles of a normal distribution scaled to the
+usual spread of an angular rate, so every symbol is about as likely.
+
+A symbol only takes a nibble, so a segment of a word takes a byte per axis
+and the word of a full trace is about eight times smaller than the trace.
+Longer segments make smaller words, but a gesture swings within a few
+hundred milliseconds and its averages over longer segments are too flat to
+bound anything. Each symbol of a word is stored as the range of the lowest
+and highest symbol of the segment: a password has a single symbol per
+segment, a key envelope has the symbols of the averages of its lower and
+upper envelope in the segment.
+
+The MINDIST of two words is the least distance the gap between their
+symbols allows. Compared with the word of a key envelope, it is never above
+the LB_Keogh bound of the password, so it never exceeds the dynamic time
+warping score either, and it costs one table lookup per segment instead of
+one per point. The word is a cheaper first bound next to the key template
+and envelope, it does not replace them: the envelope bounds much closer and
+the exact comparison needs the template. On the recordings the words only
+reject pairs at thresholds far below the match threshold of main.cpp, where
+they reject none, so Keys::verify() has no word stage.
+
+*/
+
+// safeguards
+#ifndef sax_h
+#define sax_h
+
+#include "trace.h"
+#include "envelope.h"
+
+// sax values
+#define sax_segment 4 // trace points averaged into each symbol, 80ms at 50Hz
+#define sax_length ((trace_length + sax_segment - 1) / sax_segment) // symbols per axis
+#define sax_alphabet_max 16 // symbols held in a nibble
+#define sax_alphabet 8 // default symbols per axis
+#define sax_scale_mdps 140000 // spread of the angular rate the symbols are cut for
+
+namespace Sax{
+
+    // word of a trace or of a key envelope
+    struct Word{
+        unsigned char symbols[sax_length][3]; // x, y, z, lowest symbol in the low nibble, highest in the high nibble
+        short int size; // symbols per axis
+        short int points; // trace points the word stands for
+    };
+
+    class Sax{
+        public:
+            // constructor
+            Sax(int alphabet = sax_alphabet, short int scale = 0);
+            // public methods
+            void setAlphabet(int alphabet, short int scale);
+            void encode(const Trace::Trace &trace, Word *word);
+            void encode(Envelope::Envelope &envelope, Word *word);
+            unsigned int minDist(const Word &a, const Word &b);
+            int getAlphabet(){return alphabet;}
+        private:
+            // private methods
+            unsigned char symbol(int sum, int count);
+            // private variables
+            int alphabet;
+            int breakpoints[sax_alphabet_max - 1]; // lowest value of each symbol but the first
+            int gaps[sax_alphabet_max][sax_alphabet_max]; // least distance from symbol row above symbol column
+    };
+}
+
+#endif
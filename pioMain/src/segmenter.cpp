@@ -0,0 +1,94 @@
+#include "segmenter.h"
+
+// Segmenter constructor, sets the window length and the hold time in samples
+Segmenter::Segmenter::Segmenter(int windowShift, int hold){
+    shift = (windowShift > segment_window_shift) ? segment_window_shift : windowShift;
+    this->hold = hold;
+    setThresholds(0, 0);
+    reset();
+}
+
+// Segmenter public methods
+void Segmenter::Segmenter::reset(){
+    /*
+    Method used to wait for a new gesture.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    next = 0;
+    count = 0;
+    energy = 0;
+    quiet = 0;
+    active = false;
+    done = false;
+}
+
+void Segmenter::Segmenter::setThresholds(short int onset, short int offset){
+    /*
+    Method used to set the rates that start and end a gesture, in raw units
+    of the active full scale. They are kept as window energies.
+
+    Parameters:
+        onset: rms rate that starts a gesture
+        offset: rms rate below which the gesture may end, lower than onset
+    Returns:
+        None
+    */
+    onsetEnergy = ((unsigned long long)onset * onset) << shift;
+    offsetEnergy = ((unsigned long long)offset * offset) << shift;
+}
+
+Segmenter::Event Segmenter::Segmenter::add(const Gyro::Sample &sample){
+    /*
+    Method used to add one sample to the window and update the gesture state.
+    The window has to be full before a gesture can start.
+
+    Parameters:
+        sample: the sample to add
+    Returns:
+        segment_idle before the gesture, segment_onset on the sample that
+        starts it, segment_active during it, segment_offset on the sample
+        that ends it, hold samples after the energy dropped, and
+        segment_done after it
+    */
+    if(done){
+        return segment_done;
+    }
+
+    unsigned int sampleEnergy = (unsigned int)((int)sample.x * sample.x) +
+        (unsigned int)((int)sample.y * sample.y) +
+        (unsigned int)((int)sample.z * sample.z);
+    if(count == (1 << shift)){
+        energy -= energies[next];
+    }
+    else{
+        count++;
+    }
+    energies[next] = sampleEnergy;
+    energy += sampleEnergy;
+    next = (next + 1) & ((1 << shift) - 1);
+
+    if(!active){
+        if((count == (1 << shift)) && (energy > onsetEnergy)){
+            active = true;
+            quiet = 0;
+            return segment_onset;
+        }
+        return segment_idle;
+    }
+
+    if(energy >= offsetEnergy){
+        quiet = 0;
+        return segment_active;
+    }
+    quiet++;
+    if(quiet >= hold){
+        active = false;
+        done = true;
+        return segment_offset;
+    }
+    return segment_active;
+}
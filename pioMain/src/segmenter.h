@@ -0,0 +1,60 @@
+/*
+Segmenter Class
+
+This class finds where a gesture starts and ends in the gyro samples, so the
+idle time before and after it is left out of the recording. It keeps the
+energy of the last samples, the sum of the squared rates of every axis over
+a short window, updated in O(1) per sample by adding the newest sample and
+removing the oldest one.
+
+The gesture starts when the mean squared rate over the window goes above the
+onset threshold. It ends once the energy stayed below the lower offset
+threshold for the hold time, so short pauses within the gesture do not end
+it. The two thresholds give the hysteresis.
+
+*/
+
+// safeguards
+#ifndef segmenter_h
+#define segmenter_h
+
+#include "gyro.h"
+
+// segmenter values
+#define segment_window_shift 5 // 32 samples per window, 40ms at 800Hz
+#define segment_hold 320 // samples below the offset threshold that end a gesture, 400ms at 800Hz
+#define onset_rate_mdps 30000 // rms rate that starts a gesture in millidegrees per second
+#define offset_rate_mdps 15000 // rms rate below which a gesture may end in millidegrees per second
+
+namespace Segmenter{
+
+    // state of the segmenter after a sample
+    enum Event{segment_idle, segment_onset, segment_active, segment_offset, segment_done};
+
+    class Segmenter{
+        public:
+            // constructor
+            Segmenter(int windowShift, int hold);
+            // public methods
+            void reset();
+            void setThresholds(short int onset, short int offset);
+            Event add(const Gyro::Sample &sample);
+            bool isActive(){return active;}
+            bool isDone(){return done;}
+            int getHold(){return hold;}
+        private:
+            int shift;
+            int hold;
+            unsigned int energies[1 << segment_window_shift]; // energy of each sample in the window
+            int next; // oldest sample of the window
+            int count;
+            unsigned long long energy; // sum of the window
+            unsigned long long onsetEnergy;
+            unsigned long long offsetEnergy;
+            int quiet; // samples in a row below the offset threshold
+            bool active;
+            bool done;
+    };
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "trace.h"
+
+// Trace constructor, starts empty
+Trace::Trace::Trace(){
+    clear();
+}
+
+// Trace public methods
+void Trace::Trace::clear(){
+    /*
+    Method used to empty the trace.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    size = 0;
+}
+
+bool Trace::Trace::add(const Gyro::Sample &sample){
+    /*
+    Method used to add a sample of the matching stream to the trace.
+
+    Parameters:
+        sample: the sample to add
+    Returns:
+        true if a new point was appended
+    */
+    Point point;
+    point.x = sample.x;
+    point.y = sample.y;
+    point.z = sample.z;
+    return append(point);
+}
+
+bool Trace::Trace::append(const Point &point){
+    /*
+    Method used to append a point to the trace, ignored once the trace is full.
+
+    Parameters:
+        point: the point to append
+    Returns:
+        true if the point was appended
+    */
+    if(size < trace_length){
+        points[size] = point;
+        size++;
+        return true;
+    }
+    return false;
+}
+
+void Trace::Trace::trim(int samples){
+    /*
+    Method used to remove the points standing for the last gyro samples,
+    trace_decimation samples per point, rounded up.
+
+    Parameters:
+        samples: number of gyro samples to remove
+    Returns:
+        None
+    */
+    if(samples > 0){
+        int points = (samples + trace_decimation - 1) / trace_decimation;
+        size = (points < size) ? size - points : 0;
+    }
+}
@@ -0,0 +1,50 @@
+/*
+Trace Class
+
+This class stores the angular rate trace of a recording for the matchers.
+The points are the samples of the matching stream of the pipeline, one every
+trace_decimation gyro samples, so at the 800Hz recording rate the trace
+holds one 3 axis point every 20ms. Once the trace is full, later samples are
+ignored.
+
+*/
+
+// safeguards
+#ifndef trace_h
+#define trace_h
+
+#include "gyro.h"
+
+// trace values
+#define trace_length 512 // points, about 10 seconds at 50Hz
+#define trace_decimation 16 // gyro samples per point, the matching factor of the pipeline
+
+namespace Trace{
+
+    // one averaged x, y, z angular rate
+    struct Point{
+        short int x;
+        short int y;
+        short int z;
+    };
+
+    class Trace{
+        public:
+            // constructor
+            Trace();
+            // public methods
+            void clear();
+            bool add(const Gyro::Sample &sample);
+            bool append(const Point &point);
+            void trim(int samples);
+            int getSize() const {return size;}
+            const Point *getPoints() const {return points;}
+            const Point &operator[](int i) const {return points[i];}
+            const Point &last() const {return points[size - 1];}
+        private:
+            Point points[trace_length];
+            int size;
+    };
+}
+
+#endif
@@ -0,0 +1,363 @@
+#include "vptree.h"
+#include "dtw.h"
+#include <climits>
+
+// Vptree constructor, starts empty
+Vptree::Vptree::Vptree(){
+    for(int i = 0; i < vptree_nodes; i++){
+        nodes[i].used = false;
+    }
+    for(int slot = 0; slot < vptree_capacity; slot++){
+        slotNodes[slot] = no_node;
+    }
+    root = no_node;
+    size = 0;
+    removed = 0;
+    depth = 0;
+}
+
+// Vptree public methods
+void Vptree::Vptree::insert(int slot, const Trace::Trace &trace){
+    /*
+    Method used to add the key of a slot, replacing the one it had. The new
+    node walks down from the root, inside or outside of every node on the
+    way, and becomes a leaf. The first child of a leaf sets its radius.
+
+    Parameters:
+        slot: key slot, from 0 to vptree_capacity - 1
+        trace: the key trace
+    Returns:
+        None
+    */
+    remove(slot);
+    int node = allocate();
+    if(node == no_node){
+        return;
+    }
+    Node &added = nodes[node];
+    added.slot = slot;
+    added.inside = no_node;
+    added.outside = no_node;
+    added.used = true;
+    added.removed = false;
+    added.radius = -1;
+    sign(trace, added.signature);
+    slotNodes[slot] = node;
+    size++;
+
+    if(root == no_node){
+        root = node;
+        depth = 1;
+        return;
+    }
+    int current = root;
+    int level = 1;
+    while(1){
+        level++;
+        Node &parent = nodes[current];
+        int d = (int)distance(added.signature, parent.signature);
+        if(parent.radius < 0){
+            parent.radius = d;
+            parent.inside = node;
+            break;
+        }
+        short int *child = (d <= parent.radius) ? &parent.inside : &parent.outside;
+        if(*child == no_node){
+            *child = node;
+            break;
+        }
+        current = *child;
+    }
+    if(level > depth){
+        depth = level;
+    }
+
+    //rebuild once the tree is much deeper than a balanced one
+    int balanced = 1;
+    while((1 << balanced) <= size){
+        balanced++;
+    }
+    if(depth > 2 * balanced + 2){
+        rebuild();
+    }
+}
+
+void Vptree::Vptree::remove(int slot){
+    /*
+    Method used to remove the key of a slot. Its node stays in the tree to
+    route the search until the next rebuild.
+
+    Parameters:
+        slot: key slot
+    Returns:
+        None
+    */
+    int node = slotNodes[slot];
+    if(node == no_node){
+        return;
+    }
+    nodes[node].removed = true;
+    slotNodes[slot] = no_node;
+    size--;
+    removed++;
+    if(removed > size){
+        rebuild();
+    }
+}
+
+int Vptree::Vptree::nearest(const Trace::Trace &trace, int count, int *slots, unsigned int *distances, unsigned int reach){
+    /*
+    Method used to find the keys closest to a password. Going down the tree,
+    the side of a node the password falls on is searched first, and the
+    other side only while it can still hold a key within the reach and
+    closer than the furthest one found so far.
+
+    Parameters:
+        trace: the password trace
+        count: most keys to find
+        slots: array that will store the slots of the keys, closest first
+        distances: array that will store the distance of each key
+        reach: largest distance of a key to find, vptree_unbounded for any
+    Returns:
+        number of keys found
+    */
+    int found = 0;
+    sign(trace, query);
+    search(root, query, count, reach, slots, distances, &found);
+    return found;
+}
+
+void Vptree::Vptree::rebuild(){
+    /*
+    Method used to rebuild the tree balanced from the keys in use, dropping
+    the removed nodes.
+
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    int count = 0;
+    for(int i = 0; i < vptree_nodes; i++){
+        if(nodes[i].used && !nodes[i].removed){
+            members[count] = i;
+            count++;
+        }
+        else{
+            nodes[i].used = false;
+        }
+    }
+    removed = 0;
+    depth = 0;
+    root = build(0, count, 1);
+}
+
+// Vptree private methods
+void Vptree::Vptree::sign(const Trace::Trace &trace, Trace::Point *signature){
+    /*
+    Method used to reduce a trace to its signature, each point the average
+    of an equal part of the trace. A trace shorter than the signature has
+    its points repeated.
+
+    Parameters:
+        trace: the trace
+        signature: array that will store the signature_length points
+    Returns:
+        None
+    */
+    int n = trace.getSize();
+    for(int k = 0; k < signature_length; k++){
+        int low = k * n / signature_length;
+        int high = (k + 1) * n / signature_length;
+        if(high <= low){
+            high = low + 1;
+        }
+        int sum[3] = {0, 0, 0};
+        for(int i = low; (i < high) && (i < n); i++){
+            sum[0] += trace[i].x;
+            sum[1] += trace[i].y;
+            sum[2] += trace[i].z;
+        }
+        int points = (n > 0) ? high - low : 1;
+        signature[k].x = (short int)(sum[0] / points);
+        signature[k].y = (short int)(sum[1] / points);
+        signature[k].z = (short int)(sum[2] / points);
+    }
+}
+
+unsigned int Vptree::Vptree::distance(const Trace::Point *a, const Trace::Point *b){
+    /*
+    Method used to find the edit distance with real penalty of two
+    signatures. Points are matched like dynamic time warping, but a point
+    left unmatched costs its distance to zero, which keeps the triangle
+    inequality.
+
+    Parameters:
+        a: first signature
+        b: second signature
+    Returns:
+        the distance
+    */
+    static const Trace::Point zero = {0, 0, 0};
+    unsigned int *previous = rows[0];
+    unsigned int *current = rows[1];
+    previous[0] = 0;
+    for(int j = 1; j <= signature_length; j++){
+        previous[j] = previous[j - 1] + Dtw::pointCost(b[j - 1], zero);
+    }
+    for(int i = 1; i <= signature_length; i++){
+        unsigned int gapA = Dtw::pointCost(a[i - 1], zero);
+        current[0] = previous[0] + gapA;
+        for(int j = 1; j <= signature_length; j++){
+            unsigned int best = previous[j - 1] + Dtw::pointCost(a[i - 1], b[j - 1]);
+            unsigned int skipA = previous[j] + gapA;
+            unsigned int skipB = current[j - 1] + Dtw::pointCost(b[j - 1], zero);
+            if(skipA < best){
+                best = skipA;
+            }
+            if(skipB < best){
+                best = skipB;
+            }
+            current[j] = best;
+        }
+        unsigned int *swap = previous;
+        previous = current;
+        current = swap;
+    }
+    return previous[signature_length];
+}
+
+int Vptree::Vptree::allocate(){
+    /*
+    Method used to find a free node, rebuilding the tree to free the removed
+    nodes if needed.
+
+    Parameters:
+        None
+    Returns:
+        the free node, no_node if the index is full
+    */
+    if(size >= vptree_capacity){
+        return no_node;
+    }
+    for(int pass = 0; pass < 2; pass++){
+        for(int i = 0; i < vptree_nodes; i++){
+            if(!nodes[i].used){
+                return i;
+            }
+        }
+        rebuild();
+    }
+    return no_node;
+}
+
+int Vptree::Vptree::build(int first, int count, int level){
+    /*
+    Method used to build a balanced subtree from members[first] onwards.
+    The first member becomes the vantage point, the others are sorted by
+    their distance to it and split at the median distance, the radius.
+
+    Parameters:
+        first: first member of the subtree
+        count: number of members of the subtree
+        level: depth of the subtree root
+    Returns:
+        the root of the subtree, no_node if it is empty
+    */
+    if(count == 0){
+        return no_node;
+    }
+    if(level > depth){
+        depth = level;
+    }
+    int vantage = members[first];
+    Node &node = nodes[vantage];
+    node.inside = no_node;
+    node.outside = no_node;
+    node.radius = -1;
+    if(count == 1){
+        return vantage;
+    }
+
+    //sort the other members by distance, few enough for an insertion sort
+    int start = first + 1;
+    int rest = count - 1;
+    for(int i = start; i < start + rest; i++){
+        spread[i] = distance(node.signature, nodes[members[i]].signature);
+        int j = i;
+        while((j > start) && (spread[j - 1] > spread[j])){
+            unsigned int d = spread[j];
+            spread[j] = spread[j - 1];
+            spread[j - 1] = d;
+            short int m = members[j];
+            members[j] = members[j - 1];
+            members[j - 1] = m;
+            j--;
+        }
+    }
+
+    //members at the median distance all go inside
+    int split = (rest - 1) / 2;
+    while((split + 1 < rest) && (spread[start + split + 1] == spread[start + split])){
+        split++;
+    }
+    node.radius = (int)spread[start + split];
+    node.inside = build(start, split + 1, level + 1);
+    node.outside = build(start + split + 1, rest - split - 1, level + 1);
+    return vantage;
+}
+
+void Vptree::Vptree::search(int node, const Trace::Point *query, int count, unsigned int reach, int *slots, unsigned int *distances, int *found){
+    /*
+    Method used to search a subtree for keys within the reach closer than the
+    ones found. A key of the inside subtree is at least the distance of the
+    password to the vantage point less the radius away, a key of the outside
+    subtree at least the radius less that distance, so a subtree is skipped
+    once that exceeds the furthest distance still of interest.
+
+    Parameters:
+        node: root of the subtree
+        query: signature of the password
+        count: most keys to find
+        reach: largest distance of a key to find
+        slots: slots of the keys found, closest first
+        distances: distance of each key found
+        found: pointer to the number of keys found
+    Returns:
+        None
+    */
+    if(node == no_node){
+        return;
+    }
+    Node &vantage = nodes[node];
+    unsigned int d = distance(query, vantage.signature);
+
+    if(!vantage.removed && (d <= reach) && ((*found < count) || (d < distances[*found - 1]))){
+        //insert in order, dropping the furthest if the list is full
+        int i = (*found < count) ? (*found)++ : count - 1;
+        while((i > 0) && (distances[i - 1] > d)){
+            distances[i] = distances[i - 1];
+            slots[i] = slots[i - 1];
+            i--;
+        }
+        distances[i] = d;
+        slots[i] = vantage.slot;
+    }
+    if(vantage.radius < 0){
+        return;
+    }
+
+    unsigned int radius = (unsigned int)vantage.radius;
+    if(d <= radius){
+        search(vantage.inside, query, count, reach, slots, distances, found);
+        if(radius - d <= ((*found < count) ? reach : distances[*found - 1])){
+            search(vantage.outside, query, count, reach, slots, distances, found);
+        }
+    }
+    else{
+        search(vantage.outside, query, count, reach, slots, distances, found);
+        if(d - radius <= ((*found < count) ? reach : distances[*found - 1])){
+            search(vantage.inside, query, count, reach, slots, distances, found);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/*
+Vptree Class
+
+This class indexes the key templates of many users in a vantage point tree,
+so the keys closest to a password are found without comparing it with every
+key. Each key is reduced to a signature of signature_length points, the
+averages of equal parts of its trace, and signatures are compared with the
+edit distance with real penalty (ERP). ERP aligns the points elastically
+like dynamic time warping but is a metric, so the triangle inequality lets
+the search skip every subtree that can not hold a closer key. A search can
+also be limited to the keys within a reach of the password, skipping every
+subtree that lies beyond it.
+
+Every node holds one key and a radius: the keys in its inside subtree are
+within the radius of it, the ones in its outside subtree are further away.
+A new key is inserted by walking down from the root, so adding a key costs
+one path of comparisons. A changed or removed key is only marked, it keeps
+routing the search. The tree is rebuilt balanced around median radii once
+it gets too deep or too many nodes are marked.
+
+The tree is a few hundred kilobytes, so it is placed in the SDRAM next to
+the LCD frame buffers instead of the internal RAM.
+
+*/
+
+// safeguards
+#ifndef vptree_h
+#define vptree_h
+
+#include "trace.h"
+
+// vptree values
+#define vptree_capacity 256 // keys in the index
+#define vptree_nodes (2 * vptree_capacity) // marked nodes stay until the next rebuild
+#define signature_length 64 // points per key signature
+#define no_node -1
+#define vptree_unbounded 0xFFFFFFFFU // reach of a search for the closest keys however far
+
+namespace Vptree{
+
+    // one key in the tree
+    struct Node{
+        short int slot; // key slot of the node
+        short int inside; // nodes within the radius
+        short int outside; // nodes beyond the radius
+        bool used; // node is in the tree
+        bool removed; // node only routes the search
+        int radius; // -1 until the first child is inserted
+        Trace::Point signature[signature_length];
+    };
+
+    class Vptree{
+        public:
+            // constructor
+            Vptree();
+            // public methods
+            void insert(int slot, const Trace::Trace &trace);
+            void remove(int slot);
+            int nearest(const Trace::Trace &trace, int count, int *slots, unsigned int *distances, unsigned int reach = vptree_unbounded);
+            void rebuild();
+            int getSize(){return size;}
+            int getDepth(){return depth;}
+        private:
+            // private methods
+            void sign(const Trace::Trace &trace, Trace::Point *signature);
+            unsigned int distance(const Trace::Point *a, const Trace::Point *b);
+            int allocate();
+            int build(int first, int count, int level);
+            void search(int node, const Trace::Point *query, int count, unsigned int reach, int *slots, unsigned int *distances, int *found);
+            // private variables
+            Node nodes[vptree_nodes];
+            int root;
+            int size; // keys in the tree
+            int removed; // marked nodes in the tree
+            int depth; // longest path from the root
+            short int slotNodes[vptree_capacity]; // node of the key of each slot
+            Trace::Point query[signature_length]; // signature of the password being searched
+            short int members[vptree_nodes]; // scratch for rebuild
+            unsigned int spread[vptree_nodes]; // scratch for rebuild
+            unsigned int rows[2][signature_length + 1];
+    };
+}
+
+#endif
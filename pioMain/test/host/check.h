@@ -0,0 +1,51 @@
+/*
+Check helpers
+
+Helpers shared by the host tests. A failed check prints the file, the line
+and the condition and is counted, and every test returns the count so make
+stops on the first test that failed. ticks() reads the time stamp counter
+where there is one, for the benchmarks.
+
+*/
+
+// safeguards
+#ifndef check_h
+#define check_h
+
+#include <cstdio>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// check values
+#define check(condition) Check::expect((condition), #condition, __FILE__, __LINE__)
+
+namespace Check{
+
+    static int failures = 0;
+
+    inline bool expect(bool passed, const char *condition, const char *file, int line){
+        if(!passed){
+            printf("%s:%d: check failed: %s\n", file, line, condition);
+            failures++;
+        }
+        return passed;
+    }
+
+    inline unsigned long long ticks(){
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc(); // cycles of the host, not of the Cortex-M4
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    inline int finish(const char *name){
+        printf("%s: %s\n", name, (failures == 0) ? "passed" : "FAILED");
+        return failures;
+    }
+}
+
+#endif
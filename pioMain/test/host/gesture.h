@@ -0,0 +1,73 @@
+/*
+Gesture traces
+
+Plays the recordings the way recordGyro() sees them: brought up to 800Hz,
+through the spike and noise filters and the pipeline, cut into gestures by
+the segmenter. The points of the matching stream during a gesture make its
+trace, trimmed of the pause that ended it, as recordSample() does. Each
+gesture stands for the password of a different user.
+
+*/
+
+// safeguards
+#ifndef gesture_h
+#define gesture_h
+
+#include <vector>
+#include "recording.h"
+#include "segmenter.h"
+#include "pipeline.h"
+#include "dsp.h"
+
+// gesture values
+#define gesture_rate_hz 800 // recording rate
+#define gesture_period 1250 // microseconds per sample at the recording rate
+#define gesture_cutoff 40 // noiseCutoff of main.cpp
+#define gesture_display 4 // displayFactor of main.cpp
+#define gesture_sensitivity 875 // hundredths of mdps per digit at 245dps
+
+namespace Gesture{
+
+    inline short int rawRate(long mdps){
+        return (short int)(mdps * 100 / gesture_sensitivity);
+    }
+
+    inline std::vector<Trace::Trace> traces(const char *directory){
+        //the trace of every gesture of every recording
+        static Dsp::Median spikeFilter;
+        static Dsp::Biquad noiseFilter;
+        static Pipeline::Pipeline pipeline;
+        static Segmenter::Segmenter segmenter(segment_window_shift, segment_hold);
+        pipeline.configure(trace_decimation, gesture_display);
+        std::vector<Trace::Trace> found;
+        for(int r = 0; r < Recording::count; r++){
+            spikeFilter.reset();
+            noiseFilter.setLowpass(gesture_rate_hz, gesture_cutoff);
+            noiseFilter.reset();
+            pipeline.reset();
+            segmenter.reset();
+            segmenter.setThresholds(rawRate(onset_rate_mdps), rawRate(offset_rate_mdps));
+            Trace::Trace trace;
+            for(Gyro::Sample sample : Recording::resample(Recording::load(directory, Recording::names[r]), gesture_period)){
+                spikeFilter.apply(&sample);
+                noiseFilter.apply(&sample);
+                int outputs = pipeline.add(sample);
+                Segmenter::Event event = segmenter.add(sample);
+                if(event == Segmenter::segment_offset){
+                    trace.trim(segmenter.getHold() - pipeline.getDelay());
+                }
+                else if(segmenter.isActive() && (outputs & Pipeline::output_match)){
+                    trace.add(pipeline.getMatch());
+                }
+                if(event == Segmenter::segment_done){
+                    found.push_back(trace);
+                    trace.clear();
+                    segmenter.reset();
+                }
+            }
+        }
+        return found;
+    }
+}
+
+#endif
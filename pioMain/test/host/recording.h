@@ -0,0 +1,112 @@
+/*
+Recording loader
+
+Reads the gyro recordings at the top of the repository, lines of raw x, y,
+z rates and the time in seconds as written by gyro_plotter.py. Lines with
+the 8192 marker the logger left on a bad read are skipped. The recordings
+can be cut into overlapping traces of averaged points, to stand in for
+many gestures, or brought up to the recording rate as gyro samples.
+
+*/
+
+// safeguards
+#ifndef recording_h
+#define recording_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "trace.h"
+
+// recording values
+#define recording_junk 8192 // x of a line the logger could not read
+
+namespace Recording{
+
+    struct Line{
+        short int x;
+        short int y;
+        short int z;
+        double time; // seconds
+    };
+
+    // names of the recordings, relative to the data directory
+    static const char *const names[] = {"data.txt", "data1.txt", "data2.txt", "data 2.txt"};
+    static const int count = sizeof(names) / sizeof(names[0]);
+
+    inline std::vector<Line> load(const char *directory, const char *name){
+        std::vector<Line> lines;
+        std::string path = std::string(directory) + "/" + name;
+        FILE *file = fopen(path.c_str(), "r");
+        if(file == NULL){
+            printf("can not open %s\n", path.c_str());
+            return lines;
+        }
+        int x, y, z;
+        double time;
+        while(fscanf(file, "%d %d %d %lf", &x, &y, &z, &time) == 4){
+            if(x == recording_junk){
+                continue;
+            }
+            lines.push_back(Line{(short int)x, (short int)y, (short int)z, time});
+        }
+        fclose(file);
+        return lines;
+    }
+
+    inline std::vector<Gyro::Sample> resample(const std::vector<Line> &lines, unsigned int period){
+        //samples every period microseconds on a straight line between the lines, the way recordHistory() fills the history
+        std::vector<Gyro::Sample> samples;
+        for(size_t i = 1; i < lines.size(); i++){
+            const Line &from = lines[i - 1];
+            const Line &to = lines[i];
+            unsigned int start = (unsigned int)(from.time * 1000000);
+            unsigned int end = (unsigned int)(to.time * 1000000);
+            for(unsigned int time = start; time < end; time += period){
+                long k = time - start;
+                long n = end - start;
+                samples.push_back(Gyro::Sample{(short int)(from.x + (to.x - from.x) * k / n), (short int)(from.y + (to.y - from.y) * k / n),
+                    (short int)(from.z + (to.z - from.z) * k / n), time, (unsigned int)samples.size()});
+            }
+        }
+        return samples;
+    }
+
+    inline std::vector<Trace::Trace> cut(const std::vector<Line> &lines, int decimation, int length, int step){
+        //points are the means of decimation lines, a trace starts every step points
+        std::vector<Trace::Point> points;
+        for(size_t i = 0; i + decimation <= lines.size(); i += decimation){
+            int sum[3] = {0, 0, 0};
+            for(int k = 0; k < decimation; k++){
+                sum[0] += lines[i + k].x;
+                sum[1] += lines[i + k].y;
+                sum[2] += lines[i + k].z;
+            }
+            points.push_back(Trace::Point{(short int)(sum[0] / decimation), (short int)(sum[1] / decimation), (short int)(sum[2] / decimation)});
+        }
+        std::vector<Trace::Trace> traces;
+        for(size_t first = 0; first + length <= points.size(); first += step){
+            Trace::Trace trace;
+            for(int i = 0; i < length; i++){
+                trace.append(points[first + i]);
+            }
+            traces.push_back(trace);
+        }
+        return traces;
+    }
+
+    inline std::vector<Trace::Trace> cutAll(const char *directory, int decimation, int length, int step){
+        //traces of every recording, lengths varying around length
+        std::vector<Trace::Trace> traces;
+        for(int r = 0; r < count; r++){
+            std::vector<Line> lines = load(directory, names[r]);
+            for(int variant = 0; variant < 3; variant++){
+                std::vector<Trace::Trace> part = cut(lines, decimation, length + (variant - 1) * length / 5, step);
+                traces.insert(traces.end(), part.begin(), part.end());
+            }
+        }
+        return traces;
+    }
+}
+
+#endif
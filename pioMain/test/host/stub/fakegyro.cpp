@@ -0,0 +1,205 @@
+#include "fakegyro.h"
+#include "gyro.h"
+
+// FakeGyro constructor, powered down with the register defaults of the datasheet
+FakeGyro::FakeGyro::FakeGyro(PinName chipSelect, PinName int1, PinName int2){
+    this->int1 = int1;
+    this->int2 = int2;
+    source = [](unsigned int, short int *xyz){xyz[0] = 0; xyz[1] = 0; xyz[2] = 0;};
+    dead = false;
+    memset(registers, 0, sizeof(registers));
+    registers[who_am_i] = id;
+    registers[ctrl_reg1] = 0x07;
+    head = 0;
+    level = 0;
+    output[0] = 0;
+    output[1] = 0;
+    output[2] = 0;
+    produced = 0;
+    generation = 0;
+    transactions = 0;
+    bytes = 0;
+    position = 0;
+    address = 0;
+    reading = false;
+    increment = false;
+    Host::attach(chipSelect, this);
+    Host::setPin(int1, 0);
+    Host::setPin(int2, 0);
+}
+
+// FakeGyro bus methods
+void FakeGyro::FakeGyro::select(){
+    transactions++;
+    position = 0;
+}
+
+void FakeGyro::FakeGyro::deselect(){
+    position = 0;
+}
+
+unsigned char FakeGyro::FakeGyro::exchange(unsigned char out){
+    /*
+    Method used to clock one byte. The first byte of a transaction is the
+    command: read bit, increment bit and register address. Every byte after
+    it is written to or read from the current address.
+
+    Parameters:
+        out: byte sent by the master
+    Returns:
+        byte sent back
+    */
+    bytes++;
+    if(position++ == 0){
+        reading = (out & 0x80) != 0;
+        increment = (out & 0x40) != 0;
+        address = out & 0x3F;
+        return 0xFF;
+    }
+    unsigned char in = 0xFF;
+    if(reading){
+        in = read(address);
+    }
+    else{
+        write(address, out);
+    }
+    if(increment){
+        //with the fifo on, the output registers wrap so the whole fifo is read at once
+        address = (fifoOn() && (address == out_z_h)) ? out_x_l : ((address + 1) & (fake_registers - 1));
+    }
+    return dead ? 0x00 : in;
+}
+
+// FakeGyro private methods
+void FakeGyro::FakeGyro::write(int address, unsigned char value){
+    switch(address){
+        case who_am_i:
+        case status_reg:
+        case fifo_src_reg:
+        case int1_src:
+            return; //read only
+        default:
+            break;
+    }
+    unsigned char old = registers[address];
+    registers[address] = value;
+    if((address == ctrl_reg1) && (old != value)){
+        start();
+    }
+    if((address == fifo_ctrl_reg) && ((value & 0xE0) == fifo_bypass_mode)){
+        head = 0;
+        level = 0;
+    }
+    if((address == ctrl_reg3) && !(value & int2_data_ready)){
+        Host::setPin(int2, 0);
+    }
+}
+
+unsigned char FakeGyro::FakeGyro::read(int address){
+    if((address >= out_x_l) && (address <= out_z_h)){
+        const short int *sample = output;
+        if(fifoOn() && (level > 0)){
+            sample = fifo[head];
+        }
+        int axis = (address - out_x_l) / 2;
+        unsigned char value = (address & 1) ? (unsigned char)(sample[axis] >> 8) : (unsigned char)(sample[axis] & 0xFF);
+        if(address == out_z_h){
+            //the sample was read: pop it from the fifo and lower data ready
+            if(fifoOn() && (level > 0)){
+                head = (head + 1) % fake_fifo_depth;
+                level--;
+            }
+            registers[status_reg] = 0;
+            Host::setPin(int2, 0);
+        }
+        return value;
+    }
+    if(address == fifo_src_reg){
+        unsigned char source = level & fifo_level_mask;
+        if(level == fake_fifo_depth){
+            source |= fifo_overrun;
+        }
+        if(level == 0){
+            source |= fifo_empty;
+        }
+        if(level >= (registers[fifo_ctrl_reg] & fifo_watermark_mask)){
+            source |= 0x80; //WTM
+        }
+        return source;
+    }
+    if(address == int1_src){
+        unsigned char source = registers[int1_src];
+        registers[int1_src] = 0;
+        Host::setPin(int1, 0);
+        return source;
+    }
+    return registers[address];
+}
+
+void FakeGyro::FakeGyro::start(){
+    //a new data rate or power mode restarts the sample clock
+    generation++;
+    if(registers[ctrl_reg1] & 0x08){
+        unsigned int period = 1000000 / (100 << (registers[ctrl_reg1] >> data_rate_shift));
+        unsigned int current = generation;
+        Host::schedule(Host::now() + period, [this, current](){tick(current);});
+    }
+}
+
+void FakeGyro::FakeGyro::tick(unsigned int generation){
+    /*
+    Method used to produce the next sample at the output data rate.
+
+    Parameters:
+        generation: data rate the tick was scheduled with
+    Returns:
+        None
+    */
+    if(generation != this->generation){
+        return;
+    }
+    unsigned int period = 1000000 / (100 << (registers[ctrl_reg1] >> data_rate_shift));
+    Host::schedule(Host::now() + period, [this, generation](){tick(generation);});
+
+    short int xyz[3];
+    source(produced++, xyz);
+    output[0] = xyz[0];
+    output[1] = xyz[1];
+    output[2] = xyz[2];
+    if(fifoOn() && ((registers[fifo_ctrl_reg] & 0xE0) == fifo_stream_mode)){
+        if(level == fake_fifo_depth){
+            //stream mode drops the oldest sample
+            head = (head + 1) % fake_fifo_depth;
+            level--;
+        }
+        int tail = (head + level) % fake_fifo_depth;
+        fifo[tail][0] = xyz[0];
+        fifo[tail][1] = xyz[1];
+        fifo[tail][2] = xyz[2];
+        level++;
+    }
+    registers[status_reg] = new_data;
+    if(registers[ctrl_reg3] & int2_data_ready){
+        Host::setPin(int2, 1);
+    }
+    checkThreshold(xyz);
+}
+
+bool FakeGyro::FakeGyro::fifoOn(){
+    return (registers[ctrl_reg5] & fifo_enable) != 0;
+}
+
+void FakeGyro::FakeGyro::checkThreshold(const short int *xyz){
+    //high events of every enabled axis, latched until int1_src is read
+    if(!(registers[ctrl_reg3] & int1_enable)){
+        return;
+    }
+    for(int axis = 0; axis < 3; axis++){
+        int threshold = ((registers[int1_ths_xh + 2 * axis] << 8) | registers[int1_ths_xh + 2 * axis + 1]) & int1_threshold_mask;
+        bool enabled = (registers[int1_cfg] & (0x02 << (2 * axis))) != 0;
+        if(enabled && (xyz[axis] > threshold)){
+            registers[int1_src] |= 0x40 | (0x02 << (2 * axis)); //IA and the axis high bit
+            Host::setPin(int1, 1);
+        }
+    }
+}
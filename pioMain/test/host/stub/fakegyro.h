@@ -0,0 +1,76 @@
+/*
+FakeGyro Class
+
+This class models the I3G4250D on the SPI bus of the host stub, so the Gyro
+class can be run against it. It answers the register reads and writes of
+the real device and produces samples at the output data rate written to
+ctrl_reg1, from a source function given by the test:
+-the output registers and ZYXDA of the status register
+-the 32 sample fifo in bypass and stream mode, with its level, watermark,
+ empty and overrun flags, and the address wrap from OUT_Z_H to OUT_X_L
+-the data ready signal on INT2, high from a new sample until OUT_Z_H is read
+-the latched angular rate threshold interrupt on INT1
+
+A dead bus can be simulated, every byte then reads as 0x00.
+
+*/
+
+// safeguards
+#ifndef fakegyro_h
+#define fakegyro_h
+
+#include "mbed.h"
+
+// fake gyro values
+#define fake_registers 0x40
+#define fake_fifo_depth 32
+
+namespace FakeGyro{
+
+    // source of the samples, the sample number since power on gives x, y, z
+    typedef std::function<void(unsigned int number, short int *xyz)> Source;
+
+    class FakeGyro : public Host::Device{
+        public:
+            // constructor
+            FakeGyro(PinName chipSelect, PinName int1, PinName int2);
+            // public methods
+            void setSource(Source source){this->source = source;}
+            void setDead(bool dead){this->dead = dead;}
+            unsigned int getProduced(){return produced;}
+            unsigned int getTransactions(){return transactions;}
+            unsigned int getBytes(){return bytes;}
+            int getLevel(){return level;}
+            unsigned char getRegister(int address){return registers[address & (fake_registers - 1)];}
+            // bus
+            void select() override;
+            void deselect() override;
+            unsigned char exchange(unsigned char out) override;
+        private:
+            PinName int1;
+            PinName int2;
+            Source source;
+            bool dead;
+            unsigned char registers[fake_registers];
+            short int fifo[fake_fifo_depth][3];
+            int head; // oldest sample in the fifo
+            int level; // samples in the fifo
+            short int output[3]; // sample in the output registers
+            unsigned int produced; // samples since power on
+            unsigned int generation; // changes when the data rate does, older ticks stop
+            unsigned int transactions;
+            unsigned int bytes;
+            int position; // byte of the transaction, 0 is the command
+            int address;
+            bool reading;
+            bool increment;
+            void write(int address, unsigned char value);
+            unsigned char read(int address);
+            void start();
+            void tick(unsigned int generation);
+            bool fifoOn();
+            void checkThreshold(const short int *xyz);
+    };
+}
+
+#endif
@@ -0,0 +1,275 @@
+#include "mbed.h"
+#include <map>
+#include <cstdlib>
+
+// host values
+#define host_stall 10000000ULL // microseconds a wait forever may last
+
+// the containers are built before any other static object, the global objects of main.cpp drive pins when they are built
+#define host_first __attribute__((init_priority(101)))
+
+// simulated clock and events, ordered by time then by scheduling order
+static unsigned long long clock_now = 0;
+static unsigned long long scheduled = 0;
+static std::multimap<std::pair<unsigned long long, unsigned long long>, std::function<void()>> events host_first;
+
+// pins and bus
+static std::map<int, int> levels host_first;
+static std::map<int, Callback<void()>> handlers host_first;
+static std::map<int, Host::Device *> devices host_first;
+static Host::Device *selected = NULL;
+
+// cpu model
+static unsigned int slowdown = 0;
+static unsigned long long idle_total = 0;
+static std::chrono::steady_clock::time_point woke;
+
+std::function<void()> Host::afterWait host_first;
+int Host::transferErrors = 0;
+
+unsigned long long Host::now(){
+    return clock_now;
+}
+
+void Host::schedule(unsigned long long time, std::function<void()> event){
+    /*
+    Function used to run an event at a time of the simulated clock.
+    Parameters:
+        time: microseconds, an event in the past runs on the next step
+        event: the event
+    Returns:
+        None
+    */
+    events.insert(std::make_pair(std::make_pair(time, scheduled++), event));
+}
+
+bool Host::step(unsigned long long deadline){
+    /*
+    Function used to move the clock to the next event and run it, if it comes
+    before the deadline. Otherwise the clock moves to the deadline.
+    Parameters:
+        deadline: latest time to move the clock to
+    Returns:
+        true if an event was run
+    */
+    if(events.empty() || (events.begin()->first.first > deadline)){
+        if(deadline > clock_now){
+            clock_now = deadline;
+        }
+        return false;
+    }
+    auto next = events.begin();
+    std::function<void()> event = next->second;
+    if(next->first.first > clock_now){
+        clock_now = next->first.first;
+    }
+    events.erase(next);
+    event();
+    return true;
+}
+
+void Host::advance(unsigned long long microseconds){
+    /*
+    Function used to let the simulated time pass, running every event on the way.
+    Parameters:
+        microseconds: time to let pass
+    Returns:
+        None
+    */
+    unsigned long long deadline = clock_now + microseconds;
+    while(step(deadline)){}
+}
+
+void Host::reset(){
+    /*
+    Function used to drop every event, pin and device between tests.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    events.clear();
+    levels.clear();
+    handlers.clear();
+    devices.clear();
+    selected = NULL;
+    afterWait = NULL;
+    slowdown = 0;
+    idle_total = 0;
+    transferErrors = 0;
+}
+
+static void charge(){
+    /*
+    Function used to move the clock by the time the code run since the core
+    last woke up takes on the core, when a slowdown is set.
+    */
+    if(slowdown > 0){
+        unsigned long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - woke).count();
+        Host::advance(nanoseconds * slowdown / 1000);
+    }
+}
+
+void Host::setSlowdown(unsigned int factor){
+    /*
+    Function used to let the code take simulated time, factor times its host
+    time, from now on.
+    Parameters:
+        factor: time the core takes to run the code for each unit of host time, 0 for no time
+    Returns:
+        None
+    */
+    slowdown = factor;
+    woke = std::chrono::steady_clock::now();
+}
+
+void Host::sleep(unsigned long long microseconds){
+    /*
+    Function used to let the simulated time pass with the core asleep.
+    Parameters:
+        microseconds: time to sleep
+    Returns:
+        None
+    */
+    charge();
+    unsigned long long start = clock_now;
+    advance(microseconds);
+    idle_total += clock_now - start;
+    woke = std::chrono::steady_clock::now();
+}
+
+unsigned long long Host::idle(){
+    return idle_total;
+}
+
+void Host::attach(PinName chipSelect, Device *device){
+    devices[chipSelect] = device;
+}
+
+Host::Device *Host::bus(){
+    return selected;
+}
+
+void Host::setPin(PinName pin, int level){
+    /*
+    Function used to drive a pin. A chip select going low selects its
+    device, a rising edge runs the interrupt handler of the pin.
+    Parameters:
+        pin: the pin
+        level: 0 or 1
+    Returns:
+        None
+    */
+    int old = levels.count(pin) ? levels[pin] : 0;
+    levels[pin] = level;
+    if(devices.count(pin)){
+        if((level == 0) && (selected != devices[pin])){
+            selected = devices[pin];
+            selected->select();
+        }
+        else if((level != 0) && (selected == devices[pin])){
+            selected->deselect();
+            selected = NULL;
+        }
+    }
+    if((old == 0) && (level != 0) && handlers.count(pin) && handlers[pin]){
+        handlers[pin]();
+    }
+}
+
+int Host::getPin(PinName pin){
+    return levels.count(pin) ? levels[pin] : 0;
+}
+
+void Host::onRise(PinName pin, Callback<void()> handler){
+    handlers[pin] = handler;
+}
+
+// SPI
+int SPI::write(const char *tx, int txLength, char *rx, int rxLength){
+    int length = (txLength > rxLength) ? txLength : rxLength;
+    for(int i = 0; i < length; i++){
+        char value = (char)write((i < txLength) ? tx[i] : 0xFF);
+        if(i < rxLength){
+            rx[i] = value;
+        }
+    }
+    return length;
+}
+
+int SPI::transfer(const char *tx, int txLength, char *rx, int rxLength, const event_callback_t &done, int event){
+    /*
+    The transfer takes 8 clocks per byte of simulated time. The bytes are
+    exchanged when it ends, like with DMA the transmit buffer is read while
+    the transfer runs, so a change to it before the end goes out changed.
+    */
+    if(busy){
+        return -1;
+    }
+    busy = true;
+    int length = (txLength > rxLength) ? txLength : rxLength;
+    unsigned long long duration = (unsigned long long)length * 8 * 1000000 / hz + 1;
+    int result = SPI_EVENT_COMPLETE;
+    if(Host::transferErrors > 0){
+        Host::transferErrors--;
+        result = SPI_EVENT_ERROR;
+    }
+    event_callback_t handler = done;
+    Host::schedule(Host::now() + duration, [this, tx, txLength, rx, rxLength, handler, event, result](){
+        if(result == SPI_EVENT_COMPLETE){
+            write(tx, txLength, rx, rxLength);
+        }
+        busy = false;
+        if(handler && (event & result)){
+            handler(result);
+        }
+    });
+    return 0;
+}
+
+// Timeout
+void Timeout::attach(Callback<void()> handler, std::chrono::microseconds delay){
+    unsigned int current = ++armed;
+    unsigned int *state = &armed;
+    Host::schedule(Host::now() + delay.count(), [state, current, handler](){
+        if(*state == current){
+            handler();
+        }
+    });
+}
+
+// EventFlags
+uint32_t rtos::EventFlags::wait_any(uint32_t flags, uint32_t millisec, bool clear){
+    /*
+    The simulated time runs until one of the flags is set or the wait times
+    out. A wait forever that sees nothing for host_stall simulated
+    microseconds would hang the test, it is stopped instead.
+    */
+    charge();
+    unsigned long long start = Host::now();
+    bool forever = (millisec == osWaitForever);
+    unsigned long long deadline = Host::now() + (forever ? host_stall : (unsigned long long)millisec * 1000);
+    while((this->flags & flags) == 0){
+        if(!Host::step(deadline)){
+            if(forever){
+                printf("wait forever stalled at %llu us\n", Host::now());
+                exit(2);
+            }
+            idle_total += Host::now() - start;
+            woke = std::chrono::steady_clock::now();
+            return osFlagsErrorTimeout;
+        }
+    }
+    idle_total += Host::now() - start;
+    woke = std::chrono::steady_clock::now();
+    uint32_t result = this->flags & flags;
+    if(clear){
+        this->flags &= ~flags;
+    }
+    if(Host::afterWait){
+        std::function<void()> hook = Host::afterWait;
+        Host::afterWait = NULL;
+        hook();
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+/*
+LCD stub
+
+Stand-in for the LCD_DISCO_F429ZI class of the BSP, so main.cpp builds on
+the host. It has the size of the panel and draws nothing. It uses the
+include guard of the real header, so included first it takes its place.
+
+*/
+
+// safeguards
+#ifndef __LCD_DISCO_F429ZI_H
+#define __LCD_DISCO_F429ZI_H
+
+#include <cstdint>
+
+// colors main.cpp uses, ARGB8888 like the BSP
+#define LCD_COLOR_BLUE 0xFF0000FF
+#define LCD_COLOR_GREEN 0xFF00FF00
+#define LCD_COLOR_RED 0xFFFF0000
+#define LCD_COLOR_CYAN 0xFF00FFFF
+#define LCD_COLOR_WHITE 0xFFFFFFFF
+#define LCD_COLOR_BLACK 0xFF000000
+
+// lcd stub values
+#define lcd_width 240
+#define lcd_height 320
+#define lcd_line_height 24 // Font24 of the BSP
+#define LINE(x) ((x) * lcd_line_height)
+
+typedef enum{CENTER_MODE = 0x01, RIGHT_MODE = 0x02, LEFT_MODE = 0x03} Text_AlignModeTypdef;
+
+class LCD_DISCO_F429ZI{
+    public:
+        uint32_t GetXSize(){return lcd_width;}
+        uint32_t GetYSize(){return lcd_height;}
+        void SelectLayer(uint32_t){}
+        void Clear(uint32_t){}
+        void SetBackColor(uint32_t){}
+        void SetTextColor(uint32_t){}
+        void DrawRect(uint16_t, uint16_t, uint16_t, uint16_t){}
+        void DrawVLine(uint16_t, uint16_t, uint16_t){}
+        void DrawLine(uint16_t, uint16_t, uint16_t, uint16_t){}
+        void DrawPixel(uint16_t, uint16_t, uint32_t){}
+        void DisplayStringAt(uint16_t, uint16_t, uint8_t *, Text_AlignModeTypdef){}
+};
+
+#endif
@@ -0,0 +1,251 @@
+/*
+mbed stub
+
+Stand-in for the parts of mbed the firmware modules use, so they build and
+run on the host. Time is simulated: us_ticker_read() returns the simulated
+clock, and the clock only moves when the code sleeps or waits, running the
+scheduled events on the way, such as the samples of a fake gyro or the end
+of an SPI transfer. Everything runs on the test thread, an event is run in
+place as the interrupt it stands for.
+
+The time spent in waits and sleeps is counted as idle time for
+mbed_stats_cpu_get(). By default the code itself takes no simulated time;
+with Host::setSlowdown() the code run between two waits moves the clock by
+its host time scaled to the Cortex-M4, so the share of time the core is
+busy can be measured.
+
+The SPI bus, the chip select and the interrupt pins are routed to a device
+attached with Host::attach(), see fakegyro.h.
+
+Built with a cross compiler for the Cortex-M4, the CMSIS names of the DSP
+instructions are taken from the ACLE intrinsics of the compiler, so the
+target path of the filters can be compiled without mbed.
+
+*/
+
+// safeguards
+#ifndef mbed_h
+#define mbed_h
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <functional>
+
+// CMSIS intrinsics of the DSP extension the filters use
+#if defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#define __SMLALD __smlald
+#define __QADD16 __qadd16
+#define __QSUB16 __qsub16
+#endif
+
+// pins of the DISCO_F429ZI the firmware uses
+enum PinName{PA_1, PA_2, PC_1, PF_7, PF_8, PF_9, USER_BUTTON, LED1, LED2, NC = -1};
+
+// SPI values
+#define DEVICE_SPI_ASYNCH 1
+#define SPI_EVENT_ERROR (1 << 1)
+#define SPI_EVENT_COMPLETE (1 << 2)
+#define SPI_EVENT_RX_OVERFLOW (1 << 3)
+#define SPI_EVENT_ALL (SPI_EVENT_ERROR | SPI_EVENT_COMPLETE | SPI_EVENT_RX_OVERFLOW)
+enum DMAUsage{DMA_USAGE_NEVER, DMA_USAGE_OPPORTUNISTIC, DMA_USAGE_ALWAYS};
+
+// rtos values
+#define osWaitForever 0xFFFFFFFFU
+#define osFlagsError 0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+enum osPriority{osPriorityNormal, osPriorityAboveNormal, osPriorityHigh, osPriorityRealtime};
+
+// SDRAM of the DISCO_F429ZI
+#define SDRAM_DEVICE_ADDR 0xD0000000
+#define SDRAM_DEVICE_SIZE 0x800000
+
+namespace mbed{
+
+    template <typename F> class Callback;
+
+    // callback wrapping a function or a method of an object
+    template <typename R, typename... A>
+    class Callback<R(A...)>{
+        public:
+            Callback(){}
+            Callback(R (*function)(A...)){if(function != NULL){this->function = function;}}
+            template <typename T, typename M>
+            Callback(T *object, M method){function = [object, method](A... arguments){return (object->*method)(arguments...);};}
+            template <typename F, typename = decltype(std::declval<F>()(std::declval<A>()...))>
+            Callback(F function): function(function){}
+            R operator()(A... arguments) const {return function(arguments...);}
+            explicit operator bool() const {return (bool)function;}
+        private:
+            std::function<R(A...)> function;
+    };
+
+    template <typename T, typename M>
+    Callback<void()> callback(T *object, M method){return Callback<void()>(object, method);}
+
+    template <typename T, typename R, typename A>
+    Callback<R(A)> callback(T *object, R (T::*method)(A)){return Callback<R(A)>(object, method);}
+
+    typedef Callback<void(int)> event_callback_t;
+}
+using namespace mbed;
+
+namespace Host{
+
+    // device on the SPI bus
+    class Device{
+        public:
+            virtual ~Device(){}
+            virtual void select(){}
+            virtual void deselect(){}
+            virtual unsigned char exchange(unsigned char out) = 0;
+    };
+
+    // simulated clock and events
+    unsigned long long now();
+    void schedule(unsigned long long time, std::function<void()> event);
+    void advance(unsigned long long microseconds);
+    bool step(unsigned long long deadline);
+    void reset();
+
+    // cpu model, idle time and the slowdown of the core against the host, 0 to let the code take no time
+    void setSlowdown(unsigned int slowdown);
+    void sleep(unsigned long long microseconds);
+    unsigned long long idle();
+
+    // pins and bus
+    void attach(PinName chipSelect, Device *device);
+    Device *bus();
+    void setPin(PinName pin, int level);
+    int getPin(PinName pin);
+    void onRise(PinName pin, Callback<void()> handler);
+
+    // hook run when a wait on event flags returns, to land an interrupt right after it
+    extern std::function<void()> afterWait;
+    // number of the next asynchronous SPI transfers that end with an error
+    extern int transferErrors;
+}
+
+class SPI{
+    public:
+        SPI(PinName, PinName, PinName, PinName = NC): hz(1000000), busy(false){}
+        void lock(){}
+        void unlock(){}
+        void frequency(int hz){this->hz = hz;}
+        void format(int, int = 0){}
+        int set_dma_usage(DMAUsage){return 0;}
+        int write(int value){return (Host::bus() != NULL) ? Host::bus()->exchange((unsigned char)value) : 0xFF;}
+        int write(const char *tx, int txLength, char *rx, int rxLength);
+        template <typename T>
+        int transfer(const T *tx, int txLength, T *rx, int rxLength, const event_callback_t &done, int event = SPI_EVENT_COMPLETE){
+            return transfer((const char *)tx, txLength, (char *)rx, rxLength, done, event);
+        }
+        int transfer(const char *tx, int txLength, char *rx, int rxLength, const event_callback_t &done, int event);
+        void abort_transfer(){busy = false;}
+        bool isBusy(){return busy;}
+    private:
+        int hz;
+        bool busy;
+};
+
+class DigitalOut{
+    public:
+        DigitalOut(PinName pin, int value = 0): pin(pin){Host::setPin(pin, value);}
+        DigitalOut &operator=(int value){Host::setPin(pin, value); return *this;}
+        operator int(){return Host::getPin(pin);}
+    private:
+        PinName pin;
+};
+
+class DigitalIn{
+    public:
+        DigitalIn(PinName pin): pin(pin){}
+        int read(){return Host::getPin(pin);}
+        operator int(){return read();}
+    private:
+        PinName pin;
+};
+
+class InterruptIn{
+    public:
+        InterruptIn(PinName pin): pin(pin){}
+        void rise(Callback<void()> handler){Host::onRise(pin, handler);}
+        void fall(Callback<void()>){}
+        void enable_irq(){}
+        void disable_irq(){}
+        int read(){return Host::getPin(pin);}
+    private:
+        PinName pin;
+};
+
+class Timer{
+    public:
+        Timer(): started(0), total(0), running(false){}
+        void start(){if(!running){started = Host::now(); running = true;}}
+        void stop(){if(running){total += Host::now() - started; running = false;}}
+        void reset(){total = 0; started = Host::now();}
+        std::chrono::microseconds elapsed_time(){return std::chrono::microseconds(total + (running ? Host::now() - started : 0));}
+    private:
+        unsigned long long started;
+        unsigned long long total;
+        bool running;
+};
+
+class Timeout{
+    public:
+        Timeout(): armed(0){}
+        void attach(Callback<void()> handler, std::chrono::microseconds delay);
+        void detach(){armed++;}
+    private:
+        unsigned int armed; // attach() number, an event of an older one is ignored
+};
+
+namespace rtos{
+
+    class EventFlags{
+        public:
+            EventFlags(): flags(0){}
+            uint32_t set(uint32_t flags){this->flags |= flags; return this->flags;}
+            uint32_t clear(uint32_t flags = 0x7FFFFFFF){uint32_t old = this->flags; this->flags &= ~flags; return old;}
+            uint32_t get(){return flags;}
+            uint32_t wait_any(uint32_t flags, uint32_t millisec = osWaitForever, bool clear = true);
+        private:
+            volatile uint32_t flags;
+    };
+
+    class Mutex{
+        public:
+            void lock(){}
+            void unlock(){}
+    };
+
+    class Thread{
+        public:
+            Thread(osPriority = osPriorityNormal, uint32_t = 4096){}
+            int start(Callback<void()>){return 0;}
+    };
+}
+using namespace rtos;
+
+typedef struct{
+    uint64_t uptime;
+    uint64_t idle_time;
+    uint64_t sleep_time;
+    uint64_t deep_sleep_time;
+} mbed_stats_cpu_t;
+
+inline uint32_t us_ticker_read(){return (uint32_t)Host::now();}
+inline void thread_sleep_for(uint32_t millisec){Host::sleep((unsigned long long)millisec * 1000);}
+inline void wait_us(int microseconds){Host::advance(microseconds);}
+inline void core_util_critical_section_enter(){}
+inline void core_util_critical_section_exit(){}
+inline void mbed_stats_cpu_get(mbed_stats_cpu_t *stats){
+    memset(stats, 0, sizeof(*stats));
+    stats->uptime = Host::now();
+    stats->idle_time = Host::idle();
+    stats->sleep_time = Host::idle(); // the idle thread sleeps, never deep sleeps
+}
+
+#endif
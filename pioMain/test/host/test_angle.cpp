@@ -0,0 +1,147 @@
+/*
+Angle test
+
+A synthetic gesture, turns of known angles on each axis one after the
+other, is played at 45, 90 and 180dps with jitter on the sample times. The
+steps must come out the same at every speed and the integrated angles must
+end within 0.15 degrees of the turns. A constant rate held for a minute
+must integrate to its exact angle, so the carried remainder does not drift,
+and a Q8 bias fraction given to setBias() must be removed.
+
+*/
+
+#include "angle.h"
+#include "check.h"
+#include <string>
+#include <cmath>
+
+// angle test values
+#define test_rate_hz 800 // sensor rate
+#define test_sensitivity 875 // hundredths of mdps per digit at 245dps
+#define test_tolerance 0.15 // degrees off the true angle at the end
+
+unsigned int seed = 1;
+
+unsigned int next(){
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// one turn of the gesture
+struct Turn{
+    int axis;
+    int degrees;
+};
+
+static const Turn gesture[] = {{0, 95}, {1, -65}, {2, 40}, {0, -40}, {1, 130}};
+
+double degrees(int q16){
+    return (double)q16 / (1 << angle_fraction_bits);
+}
+
+std::string play(int dps, double *turned){
+    /*
+    Function used to integrate the gesture played at a constant speed, each
+    turn with a pause before and after it.
+    Parameters:
+        dps: speed of the turns in degrees per second
+        turned: array that will store the integrated angle of each axis in degrees
+    Returns:
+        the steps, one character per axis each
+    */
+    static Angle::Angle angles;
+    angles.setSensitivity(test_sensitivity);
+    angles.setBias(0, 0, 0);
+    angles.reset();
+    std::string steps;
+    unsigned int time = 0;
+    unsigned int sequence = 0;
+    short int raw = (short int)((long)dps * 100000 / test_sensitivity);
+    for(const Turn &turn : gesture){
+        //true time of the turn, rounded to whole samples at the rate actually played
+        double rate = (double)raw * test_sensitivity / 100000;
+        int samples = (int)std::lround(std::abs(turn.degrees) / rate * test_rate_hz);
+        for(int i = -test_rate_hz / 10; i < samples + test_rate_hz / 10; i++){
+            short int values[3] = {0, 0, 0};
+            if((i >= 0) && (i < samples)){
+                values[turn.axis] = (turn.degrees > 0) ? raw : -raw;
+            }
+            angles.add(Gyro::Sample{values[0], values[1], values[2], time, sequence++});
+            //1250us per sample with up to 20us of jitter that averages out
+            time += 1250 + (int)(next() % 41) - 20;
+            char x, y, z;
+            while(angles.step(&x, &y, &z)){
+                steps += (char)('0' + x);
+                steps += (char)('0' + y);
+                steps += (char)('0' + z);
+            }
+        }
+    }
+    turned[0] = degrees(angles.getX());
+    turned[1] = degrees(angles.getY());
+    turned[2] = degrees(angles.getZ());
+    return steps;
+}
+
+void testSpeeds(){
+    double truth[3] = {0, 0, 0};
+    for(const Turn &turn : gesture){
+        truth[turn.axis] += turn.degrees;
+    }
+    static const int speeds[] = {45, 90, 180};
+    std::string first;
+    for(int dps : speeds){
+        double turned[3];
+        std::string steps = play(dps, turned);
+        double error = 0;
+        for(int axis = 0; axis < 3; axis++){
+            error = std::max(error, std::abs(turned[axis] - truth[axis]));
+        }
+        printf("%ddps: %d steps, largest error %.3f degrees\n", dps, (int)steps.size() / 3, error);
+        check(error < test_tolerance);
+        if(first.empty()){
+            first = steps;
+        }
+        check(steps == first);
+    }
+    check(first.size() == 3 * 11); // 3, 2, 1, 1 and 4 steps of 30 degrees, no turn ends on a step
+}
+
+void testDrift(){
+    //10dps for a minute is 600 degrees, each sample leaves a remainder below one Q16 unit
+    static Angle::Angle angles;
+    angles.setSensitivity(test_sensitivity);
+    angles.setBias(0, 0, 0);
+    angles.reset();
+    short int raw = 1143; // 10001.25 mdps
+    for(int i = 0; i <= 60 * test_rate_hz; i++){
+        angles.add(Gyro::Sample{raw, (short int)-raw, 0, (unsigned int)i * 1250, (unsigned int)i});
+    }
+    double expected = raw * 8.75 * 60 / 1000;
+    check(std::abs(degrees(angles.getX()) - expected) < 0.001);
+    check(std::abs(degrees(angles.getY()) + expected) < 0.001);
+    check(angles.getZ() == 0);
+}
+
+void testBias(){
+    //a still device reading 1 raw unit a third of the time has a bias of 85/256
+    static Angle::Angle angles;
+    angles.setSensitivity(test_sensitivity);
+    angles.setBias(85, 0, -85);
+    angles.reset();
+    for(int i = 0; i <= 30 * test_rate_hz; i++){
+        short int value = ((i % 3) == 0) ? 1 : 0;
+        angles.add(Gyro::Sample{value, value, (short int)-value, (unsigned int)i * 1250, (unsigned int)i});
+    }
+    //30s of a third of 8.75mdps is 0.0875 degrees, the fraction leaves a small part of it
+    check(std::abs(degrees(angles.getX())) < 0.01);
+    check(std::abs(degrees(angles.getY()) - 0.0875) < 0.01);
+    check(std::abs(degrees(angles.getZ())) < 0.01);
+}
+
+int main(){
+    testSpeeds();
+    testDrift();
+    testBias();
+    return Check::finish("test_angle");
+}
@@ -0,0 +1,83 @@
+/*
+Burst test
+
+Asynchronous reads of the Gyro class against a fake gyro on a bus that
+clocks the bytes out while simulated time passes, the way DMA reads the
+transmit buffer during the transfer. A burst must read the register it was
+started at, take the time of its bytes on the bus, keep the data of the
+previous burst valid in the other buffer, and a transfer that ends with an
+error must wake the waiting thread with dummy bytes and leave the bus
+usable.
+
+*/
+
+#include "gyro.h"
+#include "fakegyro.h"
+#include "check.h"
+
+// done callback record
+const char *doneData = NULL;
+int doneLength = -1;
+int doneCalls = 0;
+
+void burstDone(const char *data, int length){
+    doneData = data;
+    doneLength = length;
+    doneCalls++;
+}
+
+int main(){
+    FakeGyro::FakeGyro fake(PC_1, PA_1, PA_2);
+    Gyro::Gyro gyro(PF_9, PF_8, PF_7, PC_1, PA_2, PA_1);
+    check(gyro.setProfile(Gyro::odr_800hz, Gyro::bw_highest, Gyro::fs_245dps));
+
+    //a burst reads the register it was started at, the bytes take time on the bus
+    unsigned int started = us_ticker_read();
+    check(gyro.startBurst(who_am_i, 1, burstDone));
+    check(doneCalls == 0);
+    const char *first = gyro.finishBurst();
+    check(us_ticker_read() - started >= 2 * 8); //two bytes at 1MHz
+    check(doneCalls == 1);
+    check(doneLength == 1);
+    check(doneData == first);
+    check(first[0] == (char)id);
+
+    //the next burst goes to the other buffer, the previous data stays valid
+    const char *second = NULL;
+    check(gyro.startBurst(ctrl_reg1, 3));
+    second = gyro.finishBurst();
+    check(second != first);
+    check(first[0] == (char)id);
+    check(second[0] == (char)0xFF); //ctrl1 of the 800Hz profile
+    check(second[1] == (char)gyro.getProfile().ctrl2);
+    check(second[2] == 0x00); //ctrl_reg3
+
+    //a failed transfer wakes the thread with dummy bytes and a length of 0
+    Host::transferErrors = 1;
+    doneCalls = 0;
+    check(gyro.startBurst(who_am_i, 1, burstDone));
+    const char *failed = gyro.finishBurst();
+    check(doneCalls == 1);
+    check(doneLength == 0);
+    check(failed[0] == 0x00);
+
+    //the bus is released and the next burst reads the device again
+    check(gyro.startBurst(who_am_i, 1));
+    check(gyro.finishBurst()[0] == (char)id);
+    check(gyro.check_gyro());
+
+    //a whole fifo in one burst, every sample read from the device
+    fake.setSource([](unsigned int number, short int *xyz){xyz[0] = (short int)(number + 1); xyz[1] = 2; xyz[2] = 3;});
+    gyro.enableFifo(0);
+    wait_us(40 * 1250);
+    Gyro::Sample samples[fifo_depth];
+    int count = gyro.readFifo(samples, fifo_depth);
+    check(count == fifo_depth);
+    bool read = true;
+    for(int i = 0; i < count; i++){
+        read = read && (samples[i].x != 0) && (samples[i].y == 2) && (samples[i].z == 3);
+    }
+    check(read);
+
+    return Check::finish("test_burst");
+}
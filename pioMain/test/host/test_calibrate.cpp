@@ -0,0 +1,84 @@
+/*
+Calibration test
+
+The Gyro class calibrates against a fake gyro that replays data.txt, the
+motion of a real recording, and then holds still with an offset injected
+on every axis and some noise. The bias must come out as the offset. A gyro
+that never holds still must give up after the given windows, and a dead
+bus must neither calibrate nor keep init() from returning.
+
+*/
+
+#include "gyro.h"
+#include "fakegyro.h"
+#include "recording.h"
+#include "check.h"
+
+// calibration test values
+#define test_motion 600 // samples of the recording before the gyro holds still
+#define test_noise 16 // peak to peak noise of a still axis, raw units
+#define test_limit 30000000 // microseconds a calibration may take
+
+std::vector<Recording::Line> motion;
+short int offsets[3] = {40, -25, 12};
+bool still = true;
+
+void replay(unsigned int number, short int *xyz){
+    //the recording first, then still with the offsets and a little noise
+    if(!still || (number < test_motion)){
+        const Recording::Line &line = motion[number % motion.size()];
+        xyz[0] = line.x;
+        xyz[1] = line.y;
+        xyz[2] = line.z;
+        return;
+    }
+    unsigned int noise = number * 2654435761u;
+    for(int axis = 0; axis < 3; axis++){
+        xyz[axis] = offsets[axis] + (short int)((noise >> (8 * axis)) % test_noise) - test_noise / 2;
+    }
+}
+
+int main(int argc, char **argv){
+    motion = Recording::load((argc > 1) ? argv[1] : ".", "data.txt");
+    if(!check(motion.size() > test_motion)){
+        return Check::finish("test_calibrate");
+    }
+    FakeGyro::FakeGyro fake(PC_1, PA_1, PA_2);
+    Gyro::Gyro gyro(PF_9, PF_8, PF_7, PC_1, PA_2, PA_1);
+    fake.setSource(replay);
+
+    //motion first, the bias comes from the first still window
+    unsigned int started = us_ticker_read();
+    gyro.init();
+    printf("bias x: %d y: %d z: %d in %u ms\n", gyro.getBiasX(), gyro.getBiasY(), gyro.getBiasZ(), (us_ticker_read() - started) / 1000);
+    check(abs(gyro.getBiasX() - offsets[0]) <= 1);
+    check(abs(gyro.getBiasY() - offsets[1]) <= 1);
+    check(abs(gyro.getBiasZ() - offsets[2]) <= 1);
+    check(us_ticker_read() - started < test_limit);
+
+    //a gyro that never holds still gives up
+    still = false;
+    started = us_ticker_read();
+    check(!gyro.calibrate(calibration_attempts));
+    check(us_ticker_read() - started < test_limit);
+    check(gyro.getBiasX() == 0);
+
+    //the same at the slowest data rate, the windows take eight times longer
+    check(gyro.setProfile(Gyro::odr_100hz, Gyro::bw_lowest, Gyro::fs_245dps));
+    still = true;
+    check(gyro.calibrate(calibration_attempts));
+    check(abs(gyro.getBiasX() - offsets[0]) <= 1);
+
+    //a dead bus reads an empty fifo forever, calibrate gives up and init returns
+    fake.setDead(true);
+    started = us_ticker_read();
+    check(!gyro.calibrate(calibration_attempts));
+    check(us_ticker_read() - started < 2 * test_limit);
+    started = us_ticker_read();
+    gyro.init();
+    check(!gyro.check_gyro());
+    check(us_ticker_read() - started < 1000000); //no calibration is tried
+    printf("dead bus: init returned in %u us\n", us_ticker_read() - started);
+
+    return Check::finish("test_calibrate");
+}
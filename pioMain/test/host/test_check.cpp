@@ -0,0 +1,98 @@
+/*
+Check test
+
+main.cpp is built on the host, its main() renamed, like for the recording
+test. Every other gesture of the recordings is enrolled as the key of a user,
+and each of the gestures left out is checked as a password with
+checkPassword(). The dtw score of the password against every key, taken
+here with the tolerance of the keys, tells if it should match. A password
+within the threshold of a key must be accepted. One that is not must be
+rejected after being checked against fewer keys than there are, the second
+round only going through the keys within the acceptance radius.
+
+*/
+
+#include <sys/mman.h>
+#include "lcd.h"
+#include "fakegyro.h"
+#include "recording.h"
+#include "gesture.h"
+#include "check.h"
+
+// the SDRAM of the board at its address, mapped before main.cpp places the keys in it
+static void *sdram = mmap((void *)SDRAM_DEVICE_ADDR, SDRAM_DEVICE_SIZE, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+#define main firmwareMain
+#include "main.cpp"
+#undef main
+
+// check test values
+#define test_tolerance 150 // tolerance of every key point, raw units
+
+int main(int argc, char **argv){
+    if(!check(sdram == (void *)SDRAM_DEVICE_ADDR)){
+        return Check::finish("test_check");
+    }
+    std::vector<Trace::Trace> traces = Gesture::traces((argc > 1) ? argv[1] : ".");
+    int count = traces.size();
+    if(!check(count > 10)){
+        return Check::finish("test_check");
+    }
+    unsigned int threshold = gyro.rawRate(matchThreshold);
+
+    //every other gesture enrolled, with no moves, peak events or features so only the traces decide
+    Moves::Moves noMoves;
+    Peaks::Peaks noPeaks;
+    Feature::Vector noFeatures = {};
+    int enrolled = 0;
+    for(int g = 0; g < count; g += 2){
+        int slot = enrolled++;
+        *keys->getTrace(slot) = traces[g];
+        keys->getTolerance(slot)->clear();
+        for(int i = 0; i < traces[g].getSize(); i++){
+            keys->getTolerance(slot)->append(Trace::Point{test_tolerance, test_tolerance, test_tolerance});
+        }
+        keys->enroll(slot, &noMoves, &noPeaks, &noFeatures, 1);
+        keyIndex->insert(slot, *keys->getTrace(slot));
+    }
+
+    //every gesture left out checked as a password
+    static Dtw::Dtw matcher(matchBand);
+    int genuine = 0;
+    int accepted = 0;
+    int wrong = 0;
+    int rejected = 0;
+    int mostChecked = 0;
+    int totalChecked = 0;
+    for(int g = 1; g < count; g += 2){
+        bool within = false;
+        for(int slot = 0; slot < enrolled; slot++){
+            matcher.setTolerance(keys->getTolerance(slot));
+            within = within || (matcher.compare(traces[g], *keys->getTrace(slot)) <= threshold);
+        }
+        passwordTrace = traces[g];
+        passwordMoves.clear();
+        passwordPeaks.clear();
+        passwordFeatures = noFeatures;
+        keys->start(threshold, indexSlots, 0); //nothing accepted while recording
+        bool matched = checkPassword();
+        if(within){
+            genuine++;
+            accepted += matched;
+        }
+        else{
+            wrong++;
+            rejected += !matched && (checkedKeys < enrolled);
+            mostChecked = std::max(mostChecked, checkedKeys);
+            totalChecked += checkedKeys;
+        }
+    }
+    printf("%d keys: %d/%d passwords within the threshold accepted, %d/%d others rejected, checked against %d keys at most, %d on average\n",
+        enrolled, accepted, genuine, rejected, wrong, mostChecked, (wrong > 0) ? totalChecked / wrong : 0);
+    check(genuine > 0);
+    check(wrong > 0);
+    check(accepted == genuine);
+    check(rejected == wrong);
+    return Check::finish("test_check");
+}
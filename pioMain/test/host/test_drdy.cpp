@@ -0,0 +1,95 @@
+/*
+Data ready test
+
+Interrupt driven reads of the Gyro class against a fake gyro. Every sample
+read must carry the number and time of the edge its data came from, with
+no number given twice. The race that used to break this is forced on every
+other read: a new data ready edge lands right after the wait on the event
+flag returns, before the mailbox of the interrupt is read, so the flag is
+set again for an edge that read already takes.
+
+*/
+
+#include "gyro.h"
+#include "fakegyro.h"
+#include "check.h"
+#include <climits>
+
+// data ready test values
+#define test_reads 400
+#define test_period 1250 // microseconds between samples at 800Hz
+
+bool readAll(Gyro::Gyro &gyro, bool race, int *offset){
+    /*
+    Function used to read samples and check each one against the last.
+    Parameters:
+        gyro: the gyro to read
+        race: true to land a new edge right after the wait of every other read returns
+        offset: pointer to the difference of the ramp and the numbers, kept between calls
+    Returns:
+        true if every sample was read, numbered after the previous one and holds the data of its edge
+    */
+    Gyro::Sample sample;
+    unsigned int last = 0;
+    bool ordered = true;
+    bool matched = true;
+    for(int i = 0; i < test_reads; i++){
+        if(race && ((i % 2) == 0)){
+            //the line drops and the next sample is taken, its edge fires the interrupt,
+            //the read after this one then finds the flag set with nothing new in the mailbox
+            Host::afterWait = [](){
+                Host::setPin(PA_2, 0);
+                Host::step(Host::now() + test_period);
+            };
+        }
+        if(!gyro.readSample(&sample, 10)){
+            return false;
+        }
+        if((i > 0) && (sample.sequence <= last)){
+            ordered = false;
+        }
+        if(*offset == INT_MIN){
+            *offset = sample.x - (int)sample.sequence;
+        }
+        if(sample.x - (int)sample.sequence != *offset){
+            matched = false;
+        }
+        last = sample.sequence;
+    }
+    Host::afterWait = NULL;
+    check(ordered);
+    check(matched);
+    return ordered && matched;
+}
+
+int main(){
+    FakeGyro::FakeGyro fake(PC_1, PA_1, PA_2);
+    Gyro::Gyro gyro(PF_9, PF_8, PF_7, PC_1, PA_2, PA_1);
+    fake.setSource([](unsigned int number, short int *xyz){xyz[0] = (short int)(number & 0x3FFF); xyz[1] = 0; xyz[2] = 0;});
+    check(gyro.setProfile(Gyro::odr_800hz, Gyro::bw_highest, Gyro::fs_245dps));
+    int offset = INT_MIN;
+
+    //a reader that keeps up sees every sample once
+    gyro.enableDataReady();
+    check(readAll(gyro, false, &offset));
+    check(gyro.getMissedSamples() == 0);
+
+    //an edge right after the wait: the newest sample is read once, the one before it is missed
+    unsigned int missed = gyro.getMissedSamples();
+    check(readAll(gyro, true, &offset));
+    check(gyro.getMissedSamples() - missed == test_reads / 2);
+
+    //without data ready the wait times out and no stale mailbox is read
+    gyro.disableDataReady();
+    Gyro::Sample sample;
+    check(!gyro.readSample(&sample, 5));
+
+    //the mailbox starts empty again, samples taken while disabled got no numbers
+    offset = INT_MIN;
+    gyro.enableDataReady();
+    check(readAll(gyro, false, &offset));
+    gyro.disableDataReady();
+
+    printf("samples produced: %u  missed: %u\n", fake.getProduced(), gyro.getMissedSamples());
+    return Check::finish("test_drdy");
+}
@@ -0,0 +1,345 @@
+/*
+Dsp test
+
+The plain C operations the filters use off target are checked bit for bit
+against a model of the Cortex-M4 instructions they stand for, written from
+the pseudocode of the architecture manual: SMLALD, QADD16 and QSUB16, and
+SSUB16 setting the GE flags followed by SEL, the way the asm blocks of the
+target use them. Then every filter is checked against a reference computed
+in 64 bits on noisy samples with spikes up to the full scale, so the
+saturation is hit.
+
+The time the moving average takes per sample is measured on the host and
+scaled to the Cortex-M4 like the recording test does, and its share of the
+core at the rate of the gyro must stay far below the few percent a recording
+may keep the core busy.
+
+The target path itself is not run here, it needs the Cortex-M4; make arm
+builds it with the cross compiler when there is one.
+
+*/
+
+#include "dsp.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+// dsp test values
+#define test_samples 20000 // samples per filter check
+#define test_pairs 200000 // random operand pairs per instruction
+#define test_rate 800 // samples per second of the gyro
+#define test_slowdown 40 // time the core takes for each unit of host time, as test_record
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+unsigned int seed = 1;
+
+unsigned int next(){
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// Cortex-M4 instruction model
+namespace Model{
+
+    struct Flags{
+        bool ge[4]; // GE flags, one per byte
+    };
+
+    long long smlald(unsigned int n, unsigned int m, unsigned long long accumulator){
+        long long product1 = (long long)(short int)(n & 0xFFFF) * (short int)(m & 0xFFFF);
+        long long product2 = (long long)(short int)(n >> 16) * (short int)(m >> 16);
+        return (long long)(accumulator + (unsigned long long)product1 + (unsigned long long)product2);
+    }
+
+    // SignedSat(i, 16)
+    unsigned int signedSat(int i){
+        return (unsigned int)((i > 32767) ? 32767 : (i < -32768) ? -32768 : i) & 0xFFFF;
+    }
+
+    unsigned int qadd16(unsigned int n, unsigned int m){
+        int sum1 = (int)(short int)(n & 0xFFFF) + (short int)(m & 0xFFFF);
+        int sum2 = (int)(short int)(n >> 16) + (short int)(m >> 16);
+        return signedSat(sum1) | (signedSat(sum2) << 16);
+    }
+
+    unsigned int qsub16(unsigned int n, unsigned int m){
+        int diff1 = (int)(short int)(n & 0xFFFF) - (short int)(m & 0xFFFF);
+        int diff2 = (int)(short int)(n >> 16) - (short int)(m >> 16);
+        return signedSat(diff1) | (signedSat(diff2) << 16);
+    }
+
+    unsigned int ssub16(unsigned int n, unsigned int m, Flags *flags){
+        int diff1 = (int)(short int)(n & 0xFFFF) - (short int)(m & 0xFFFF);
+        int diff2 = (int)(short int)(n >> 16) - (short int)(m >> 16);
+        flags->ge[0] = flags->ge[1] = (diff1 >= 0);
+        flags->ge[2] = flags->ge[3] = (diff2 >= 0);
+        return ((unsigned int)diff1 & 0xFFFF) | ((unsigned int)diff2 << 16);
+    }
+
+    unsigned int sel(unsigned int n, unsigned int m, const Flags &flags){
+        unsigned int result = 0;
+        for(int k = 0; k < 4; k++){
+            unsigned int mask = 0xFFu << (8 * k);
+            result |= (flags.ge[k] ? n : m) & mask;
+        }
+        return result;
+    }
+
+    // ssub16 result, a, b then sel result, b, a
+    int min16(int a, int b){
+        Flags flags;
+        ssub16(a, b, &flags);
+        return (int)sel(b, a, flags);
+    }
+
+    // ssub16 result, a, b then sel result, a, b
+    int max16(int a, int b){
+        Flags flags;
+        ssub16(a, b, &flags);
+        return (int)sel(a, b, flags);
+    }
+}
+
+short int randomHalfword(){
+    //the ends of the range and random values
+    static const short int edges[] = {-32768, -32767, -16384, -1, 0, 1, 16383, 32766, 32767};
+    if((next() % 4) == 0){
+        return edges[next() % (sizeof(edges) / sizeof(edges[0]))];
+    }
+    return (short int)next();
+}
+
+void testInstructions(){
+    int smlaldWrong = 0;
+    int addWrong = 0;
+    int subWrong = 0;
+    int minWrong = 0;
+    int maxWrong = 0;
+    for(int i = 0; i < test_pairs; i++){
+        int a = Dsp::pack(randomHalfword(), randomHalfword());
+        int b = Dsp::pack(randomHalfword(), randomHalfword());
+        long long sum = ((long long)next() << 24) ^ (long long)next() ^ ((next() & 1) ? -(1LL << 40) : 0);
+        smlaldWrong += (Dsp::smlald(a, b, sum) != Model::smlald(a, b, sum));
+        addWrong += ((unsigned int)Dsp::qadd16(a, b) != Model::qadd16(a, b));
+        subWrong += ((unsigned int)Dsp::qsub16(a, b) != Model::qsub16(a, b));
+        minWrong += (Dsp::min16(a, b) != Model::min16(a, b));
+        maxWrong += (Dsp::max16(a, b) != Model::max16(a, b));
+    }
+    check(smlaldWrong == 0);
+    check(addWrong == 0);
+    check(subWrong == 0);
+    check(minWrong == 0);
+    check(maxWrong == 0);
+}
+
+std::vector<Gyro::Sample> makeSamples(){
+    //slow swings with noise, every few hundred samples a spike to the full scale
+    std::vector<Gyro::Sample> samples(test_samples);
+    for(int i = 0; i < test_samples; i++){
+        int values[3];
+        for(int axis = 0; axis < 3; axis++){
+            int swing = ((i * (axis + 3)) % 4000) * 16 - 32000;
+            int noise = (int)(next() % 4001) - 2000;
+            values[axis] = std::max(-32768, std::min(32767, swing + noise));
+            if((next() % 300) == 0){
+                values[axis] = (next() & 1) ? 32767 : -32768;
+            }
+        }
+        samples[i] = Gyro::Sample{(short int)values[0], (short int)values[1], (short int)values[2], (unsigned int)i * 1250, (unsigned int)i};
+    }
+    return samples;
+}
+
+short int axisOf(const Gyro::Sample &sample, int axis){
+    return (axis == 0) ? sample.x : (axis == 1) ? sample.y : sample.z;
+}
+
+short int clamp(long long value){
+    return (short int)std::max(-32768LL, std::min(32767LL, value));
+}
+
+void testMedian(const std::vector<Gyro::Sample> &samples){
+    static Dsp::Median median;
+    int wrong = 0;
+    for(int i = 0; i < test_samples; i++){
+        Gyro::Sample sample = samples[i];
+        median.apply(&sample);
+        for(int axis = 0; axis < 3; axis++){
+            //the first sample stands in for the two before it
+            int window[3] = {axisOf(samples[std::max(i - 2, 0)], axis), axisOf(samples[std::max(i - 1, 0)], axis), axisOf(samples[i], axis)};
+            std::sort(window, window + 3);
+            wrong += (axisOf(sample, axis) != window[1]);
+        }
+    }
+    check(wrong == 0);
+}
+
+void testBiquad(const std::vector<Gyro::Sample> &samples, const short int *coefficients){
+    static Dsp::Biquad biquad;
+    biquad.setCoefficients(coefficients);
+    biquad.reset();
+    long long past[3][4] = {}; // x[n-1], x[n-2], y[n-1], y[n-2]
+    int wrong = 0;
+    for(int i = 0; i < test_samples; i++){
+        Gyro::Sample sample = samples[i];
+        biquad.apply(&sample);
+        for(int axis = 0; axis < 3; axis++){
+            long long *p = past[axis];
+            long long input = axisOf(samples[i], axis);
+            long long sum = coefficients[0] * input + coefficients[1] * p[0] + coefficients[2] * p[1] + coefficients[3] * p[2] + coefficients[4] * p[3];
+            long long output = clamp(sum >> biquad_shift);
+            wrong += (axisOf(sample, axis) != output);
+            p[1] = p[0];
+            p[0] = input;
+            p[3] = p[2];
+            p[2] = output;
+        }
+    }
+    check(wrong == 0);
+}
+
+void testAverage(const std::vector<Gyro::Sample> &samples, int shift){
+    static Dsp::MovingAverage average;
+    average.setShift(shift);
+    int length = 1 << shift;
+    int wrong = 0;
+    for(int i = 0; i < test_samples; i++){
+        Gyro::Sample sample = samples[i];
+        average.apply(&sample);
+        for(int axis = 0; axis < 3; axis++){
+            //zeros before the first sample
+            long long sum = 0;
+            for(int k = 0; (k < length) && (k <= i); k++){
+                sum += axisOf(samples[i - k], axis) >> shift;
+            }
+            wrong += (axisOf(sample, axis) != clamp(sum));
+        }
+        wrong += (sample.sequence != samples[i].sequence);
+    }
+    check(wrong == 0);
+}
+
+void timeAverage(const std::vector<Gyro::Sample> &samples){
+    //host time per sample of the longest average, then its share of the core at the rate of the gyro
+    static Dsp::MovingAverage average(average_shift_max);
+    long long fastest = -1;
+    int sum = 0;
+    for(int run = 0; run < test_runs; run++){
+        average.reset();
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < test_samples; i++){
+            Gyro::Sample sample = samples[i];
+            average.apply(&sample);
+            sum += sample.x + sample.y + sample.z;
+        }
+        long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        fastest = ((fastest < 0) || (nanoseconds < fastest)) ? nanoseconds : fastest;
+    }
+    double perSample = (double)fastest / test_samples;
+    double share = perSample * test_slowdown * test_rate / 1e7; // percent of the core
+    printf("moving average: %.1f ns per sample on the host, %.0f ns on the core, %.3f%% of the core at %dHz (checksum %d)\n",
+        perSample, perSample * test_slowdown, share, test_rate, sum);
+    check(share < 0.5);
+}
+
+void testFir(const std::vector<Gyro::Sample> &samples, const short int *taps, int count, int factor){
+    static Dsp::Fir fir;
+    check(fir.setTaps(taps, count, factor));
+    int wrong = 0;
+    int outputs = 0;
+    for(int i = 0; i < test_samples; i++){
+        Gyro::Sample output;
+        bool given = fir.decimate(samples[i], &output);
+        wrong += (given != ((i + 1) % factor == 0));
+        if(!given){
+            continue;
+        }
+        outputs++;
+        for(int axis = 0; axis < 3; axis++){
+            long long sum = 0;
+            for(int k = 0; (k < count) && (k <= i); k++){
+                sum += (long long)taps[k] * axisOf(samples[i - k], axis);
+            }
+            wrong += (axisOf(output, axis) != clamp(sum >> fir_shift));
+        }
+        wrong += (output.sequence != samples[i].sequence);
+    }
+    check(outputs == test_samples / factor);
+    check(wrong == 0);
+}
+
+void testCic(const std::vector<Gyro::Sample> &samples, int order, int shift){
+    static Dsp::Cic cic;
+    check(cic.configure(order, shift));
+    int factor = 1 << shift;
+    //order moving sums of factor samples, in 64 bits
+    std::vector<std::vector<long long>> sums(3, std::vector<long long>(test_samples));
+    for(int axis = 0; axis < 3; axis++){
+        for(int i = 0; i < test_samples; i++){
+            sums[axis][i] = axisOf(samples[i], axis);
+        }
+        for(int stage = 0; stage < order; stage++){
+            std::vector<long long> summed(test_samples, 0);
+            for(int i = 0; i < test_samples; i++){
+                for(int k = 0; (k < factor) && (k <= i); k++){
+                    summed[i] += sums[axis][i - k];
+                }
+            }
+            sums[axis] = summed;
+        }
+    }
+    int wrong = 0;
+    for(int i = 0; i < test_samples; i++){
+        Gyro::Sample output;
+        bool given = cic.decimate(samples[i], &output);
+        wrong += (given != ((i + 1) % factor == 0));
+        for(int axis = 0; given && (axis < 3); axis++){
+            wrong += (axisOf(output, axis) != clamp(sums[axis][i] >> (order * shift)));
+        }
+    }
+    check(wrong == 0);
+    check(!cic.configure(cic_order_max, 5)); // 16 + 4 * 5 bits do not fit
+}
+
+int main(){
+    testInstructions();
+    std::vector<Gyro::Sample> samples = makeSamples();
+    testMedian(samples);
+
+    static const short int smooth[5] = {1200, 2400, 1200, 23000, -9700}; // about the 40Hz low pass at 800Hz
+    static const short int loud[5] = {16384, 16384, 16384, 30000, -14000}; // gain far above 1, saturates
+    testBiquad(samples, smooth);
+    testBiquad(samples, loud);
+    for(int shift = 0; shift <= average_shift_max; shift++){
+        testAverage(samples, shift);
+    }
+    timeAverage(samples);
+    static Dsp::Biquad designed;
+    designed.setLowpass(800, 40);
+    Gyro::Sample dc = {8000, -8000, 0, 0, 0};
+    for(int i = 0; i < 2000; i++){
+        dc = Gyro::Sample{8000, -8000, 0, 0, 0};
+        designed.apply(&dc);
+    }
+    check((abs(dc.x - 8000) < 16) && (abs(dc.y + 8000) < 16) && (dc.z == 0)); // unit gain at DC
+
+    short int taps[fir_taps_max];
+    for(int k = 0; k < fir_taps_max; k++){
+        taps[k] = (short int)((int)(next() % 20001) - 10000);
+    }
+    testFir(samples, taps, fir_taps_max, 4);
+    testFir(samples, taps, 7, 1); // odd count, padded with a zero tap
+    static Dsp::Fir designedFir;
+    designedFir.setLowpass(16, 4);
+    Gyro::Sample out = {0, 0, 0, 0, 0};
+    for(int i = 0; i < 64; i++){
+        designedFir.decimate(Gyro::Sample{10000, -10000, 0, 0, 0}, &out);
+    }
+    check((abs(out.x - 10000) < 4) && (abs(out.y + 10000) < 4)); // unit gain at DC
+
+    testCic(samples, 1, 3);
+    testCic(samples, 3, 2);
+    testCic(samples, cic_order_max, 4);
+    return Check::finish("test_dsp");
+}
@@ -0,0 +1,129 @@
+/*
+Dtw test and benchmark
+
+The banded matcher is checked against a plain dynamic time warping over the
+whole cost matrix restricted to the same band, on traces cut from the
+recordings, with and without a threshold and in a stream of points. Then
+the cycles per comparison are measured, once running to the end and once
+abandoning at the match threshold. The cycles are those of the host, they
+only compare the variants with each other.
+
+*/
+
+#include "dtw.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// dtw test values
+#define test_decimation 4 // recording lines per point
+#define test_length 80 // points per trace, varied by a fifth
+#define test_step 20 // points between the starts of the traces
+#define test_band 25 // band of main.cpp
+#define test_threshold 5142 // 45000 mdps at 245dps, the threshold of main.cpp
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+unsigned int reference(const Trace::Trace &a, const Trace::Trace &b, int band){
+    /*
+    Function used to find the dtw score over the whole cost matrix.
+    Parameters:
+        a, b: the traces
+        band: band half width, widened to the length difference
+    Returns:
+        the score, the cost of the best path over the lengths of both traces
+    */
+    int n = a.getSize();
+    int m = b.getSize();
+    int w = (band > abs(n - m)) ? band : abs(n - m);
+    std::vector<std::vector<long long>> cost(n + 1, std::vector<long long>(m + 1, 1LL << 40));
+    cost[0][0] = 0;
+    for(int i = 1; i <= n; i++){
+        for(int j = 1; j <= m; j++){
+            if(abs(i - j) > w){
+                continue;
+            }
+            long long best = std::min(cost[i - 1][j - 1], std::min(cost[i - 1][j], cost[i][j - 1]));
+            cost[i][j] = best + Dtw::pointCost(a[i - 1], b[j - 1]);
+        }
+    }
+    return (unsigned int)(cost[n][m] / (n + m));
+}
+
+int main(int argc, char **argv){
+    std::vector<Trace::Trace> traces = Recording::cutAll((argc > 1) ? argv[1] : ".", test_decimation, test_length, test_step);
+    int count = traces.size();
+    printf("traces: %d\n", count);
+    if(!check(count > 10)){
+        return Check::finish("test_dtw");
+    }
+    static Dtw::Dtw matcher(test_band);
+
+    //the same scores as the whole matrix, the threshold only abandons what is above it
+    int wrong = 0;
+    int abandonedWrong = 0;
+    int streamedWrong = 0;
+    int pairs = 0;
+    for(int a = 0; a < count; a++){
+        for(int b = 0; b < count; b += 3){
+            unsigned int expected = reference(traces[a], traces[b], test_band);
+            if(matcher.compare(traces[a], traces[b]) != expected){
+                wrong++;
+            }
+            unsigned int bounded = matcher.compare(traces[a], traces[b], test_threshold);
+            if((bounded != expected) && ((expected <= test_threshold) || (bounded != dtw_no_match))){
+                abandonedWrong++;
+            }
+            //the points one at a time with the length known decide the same
+            matcher.start(&traces[b], test_threshold, traces[a].getSize());
+            Dtw::StreamState state = Dtw::stream_pending;
+            for(int i = 0; i < traces[a].getSize(); i++){
+                state = matcher.push(traces[a][i]);
+            }
+            if((state == Dtw::stream_accepted) != (expected <= test_threshold)){
+                streamedWrong++;
+            }
+            pairs++;
+        }
+    }
+    printf("pairs checked: %d\n", pairs);
+    check(wrong == 0);
+    check(abandonedWrong == 0);
+    check(streamedWrong == 0);
+    check(matcher.compare(traces[0], traces[0]) == 0);
+
+    //cycles per comparison
+    unsigned long long cells = 0;
+    for(int a = 0; a < count; a++){
+        for(int b = 0; b < count; b++){
+            cells += (unsigned long long)traces[a].getSize() * (2 * test_band + 1);
+        }
+    }
+    //the fastest of a few runs, the host is shared
+    unsigned long long sum = 0;
+    unsigned long long full = ~0ULL;
+    unsigned long long bounded = ~0ULL;
+    int accepted = 0;
+    for(int run = 0; run < test_runs; run++){
+        sum = 0;
+        unsigned long long start = Check::ticks();
+        for(int a = 0; a < count; a++){
+            for(int b = 0; b < count; b++){
+                sum += matcher.compare(traces[a], traces[b]);
+            }
+        }
+        full = std::min(full, Check::ticks() - start);
+        accepted = 0;
+        start = Check::ticks();
+        for(int a = 0; a < count; a++){
+            for(int b = 0; b < count; b++){
+                accepted += (matcher.compare(traces[a], traces[b], test_threshold) <= test_threshold);
+            }
+        }
+        bounded = std::min(bounded, Check::ticks() - start);
+    }
+    unsigned long long comparisons = (unsigned long long)count * count;
+    printf("full: %llu cycles per comparison, %.2f per band cell (checksum %llu)\n", full / comparisons, (double)full / cells, sum);
+    printf("threshold %d: %llu cycles per comparison, %d of %llu accepted\n", test_threshold, bounded / comparisons, accepted, comparisons);
+    return Check::finish("test_dtw");
+}
@@ -0,0 +1,129 @@
+/*
+Enrollment measurement
+
+Gestures are cut from the recordings and each is repeated a few times the
+way a user would: a little faster or slower, started a little earlier or
+later and with some noise. Five repetitions are merged into a key with
+DTW barycenter averaging, the others are held out as passwords. Their
+scores against the key are compared with their scores against a key made
+of a single repetition, for the genuine gesture and for the others, and
+the cycles of the averaging are measured.
+
+*/
+
+#include "dba.h"
+#include "dtw.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// enrollment test values
+#define test_decimation 4 // recording lines per point
+#define test_length 60 // points per gesture
+#define test_step 40 // points between the starts of the gestures
+#define test_enrolled 5 // repetitions merged into the key, enrollRepetitions of main.cpp
+#define test_held 3 // repetitions held out as passwords
+#define test_band 25 // band of main.cpp
+#define test_noise 60 // peak to peak noise added to a repetition, raw units
+
+unsigned int seed = 12345;
+
+int noise(){
+    seed = seed * 1103515245 + 12345;
+    return (int)((seed >> 16) % test_noise) - test_noise / 2;
+}
+
+Trace::Trace repeat(const Trace::Trace &gesture, int number){
+    /*
+    Function used to make one repetition of a gesture: resampled by a speed
+    between 0.85 and 1.15, shifted by up to 3 points and with noise added.
+    Parameters:
+        gesture: the gesture
+        number: repetition number, picks the speed and the shift
+    Returns:
+        the repetition
+    */
+    double speed = 0.85 + 0.3 * ((number * 7) % 11) / 10.0;
+    double shift = ((number * 5) % 7) - 3;
+    Trace::Trace trace;
+    int n = gesture.getSize();
+    for(double t = (shift > 0) ? shift : 0; t < n - 1; t += speed){
+        int i = (int)t;
+        double f = t - i;
+        const Trace::Point &a = gesture[i];
+        const Trace::Point &b = gesture[i + 1];
+        trace.append(Trace::Point{
+            (short int)(a.x + (b.x - a.x) * f + noise()),
+            (short int)(a.y + (b.y - a.y) * f + noise()),
+            (short int)(a.z + (b.z - a.z) * f + noise())});
+    }
+    return trace;
+}
+
+int main(int argc, char **argv){
+    std::vector<Trace::Trace> gestures;
+    for(int r = 0; r < Recording::count; r++){
+        std::vector<Trace::Trace> part = Recording::cut(Recording::load((argc > 1) ? argv[1] : ".", Recording::names[r]), test_decimation, test_length, test_step);
+        gestures.insert(gestures.end(), part.begin(), part.end());
+    }
+    int count = gestures.size();
+    printf("gestures: %d\n", count);
+    if(!check(count > 4)){
+        return Check::finish("test_enroll");
+    }
+
+    static Dba::Dba averager;
+    static Dtw::Dtw matcher(test_band);
+    std::vector<Trace::Trace> keys(count), tolerances(count), singles(count);
+    std::vector<std::vector<Trace::Trace>> passwords(count);
+    unsigned long long cycles = 0;
+    bool merged = true;
+    bool positive = true;
+    for(int g = 0; g < count; g++){
+        Trace::Trace recordings[test_enrolled];
+        for(int r = 0; r < test_enrolled; r++){
+            recordings[r] = repeat(gestures[g], r);
+        }
+        for(int r = 0; r < test_held; r++){
+            passwords[g].push_back(repeat(gestures[g], test_enrolled + r));
+        }
+        singles[g] = recordings[0];
+        unsigned long long start = Check::ticks();
+        merged = merged && (averager.average(recordings, test_enrolled, &keys[g], &tolerances[g]) == test_enrolled);
+        cycles += Check::ticks() - start;
+        for(int i = 0; i < tolerances[g].getSize(); i++){
+            positive = positive && (tolerances[g][i].x >= 0) && (tolerances[g][i].y >= 0) && (tolerances[g][i].z >= 0);
+        }
+    }
+    check(merged);
+    check(positive);
+
+    //mean scores of the held out repetitions against each kind of key
+    double genuine[3] = {0, 0, 0};
+    double impostor[3] = {0, 0, 0};
+    int genuineCount = 0;
+    int impostorCount = 0;
+    for(int g = 0; g < count; g++){
+        for(int k = 0; k < count; k++){
+            for(const Trace::Trace &password : passwords[g]){
+                double *sums = (g == k) ? genuine : impostor;
+                matcher.setTolerance(NULL);
+                sums[0] += matcher.compare(password, singles[k]);
+                sums[1] += matcher.compare(password, keys[k]);
+                matcher.setTolerance(&tolerances[k]);
+                sums[2] += matcher.compare(password, keys[k]);
+                ((g == k) ? genuineCount : impostorCount)++;
+            }
+        }
+    }
+    const char *names[3] = {"one recording", "averaged", "averaged with tolerance"};
+    for(int kind = 0; kind < 3; kind++){
+        printf("%-24s genuine %7.0f  impostor %7.0f  ratio %.2f\n", names[kind],
+            genuine[kind] / genuineCount, impostor[kind] / impostorCount, impostor[kind] * genuineCount / (genuine[kind] * impostorCount));
+    }
+    printf("averaging: %llu cycles per key of %d recordings\n", cycles / count, test_enrolled);
+    check(genuine[2] < genuine[0]); //the averaged key with its tolerance is closer to new repetitions
+    check(impostor[2] * genuine[0] > impostor[0] * genuine[2]); //and the impostors are further apart relative to it
+    return Check::finish("test_enroll");
+}
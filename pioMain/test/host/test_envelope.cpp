@@ -0,0 +1,191 @@
+/*
+Envelope test and benchmark
+
+The bound of the key envelopes, LB_Keogh with the projection pass, is
+checked never to rule out the dtw score of a pair, with and without a
+tolerance on the key, on traces cut from the recordings. For a few
+thresholds the share of the pairs above the threshold that LB_Keogh alone
+and the whole bound reject without the alignment is measured. Then the
+traces of the gestures of the recordings, each a key with a tolerance
+against the others, are checked at the threshold of main.cpp: the whole
+bound must reject at least test_pruned percent of the pairs above it. Last
+the cycles of the bound, of the alignment and of both in a cascade.
+
+*/
+
+#include "dtw.h"
+#include "envelope.h"
+#include "recording.h"
+#include "gesture.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// envelope test values
+#define test_decimation 4 // recording lines per point
+#define test_length 80 // points per trace, varied by a fifth
+#define test_step 20 // points between the starts of the traces
+#define test_band 25 // band of main.cpp
+#define test_tolerance 150 // tolerance of every key point, raw units
+#define test_threshold 5142 // matchThreshold of main.cpp at 245dps
+#define test_pruned 5 // least percent of the gesture pairs above test_threshold the bound rejects
+
+unsigned int keogh(Envelope::Envelope &envelope, const Trace::Trace &password){
+    //the LB_Keogh pass of the bound alone
+    unsigned int sum = 0;
+    if(envelope.covers(password.getSize())){
+        for(int i = 0; i < password.getSize(); i++){
+            sum += envelope.pointBound(i, password[i]);
+        }
+    }
+    return sum;
+}
+
+void testGestures(const char *directory){
+    std::vector<Trace::Trace> traces = Gesture::traces(directory);
+    int count = traces.size();
+    printf("gestures: %d\n", count);
+    if(!check(count > 10)){
+        return;
+    }
+    static Dtw::Dtw matcher(test_band);
+    static std::vector<Envelope::Envelope> envelopes(count);
+    std::vector<Trace::Trace> tolerances(count);
+    for(int k = 0; k < count; k++){
+        for(int i = 0; i < traces[k].getSize(); i++){
+            tolerances[k].append(Trace::Point{test_tolerance, test_tolerance, test_tolerance});
+        }
+        envelopes[k].build(traces[k], &tolerances[k], test_band);
+    }
+    int above = 0;
+    int wrong = 0;
+    int byKeogh = 0;
+    int byBound = 0;
+    for(int p = 0; p < count; p++){
+        for(int k = 0; k < count; k++){
+            if(p == k){
+                continue;
+            }
+            int n = traces[p].getSize();
+            matcher.setTolerance(&tolerances[k]);
+            unsigned int score = matcher.compare(traces[p], traces[k]);
+            unsigned int bound = envelopes[k].lowerBound(traces[p]);
+            wrong += envelopes[k].rejects(bound, score, n);
+            if(score > test_threshold){
+                above++;
+                byKeogh += envelopes[k].rejects(keogh(envelopes[k], traces[p]), test_threshold, n);
+                byBound += envelopes[k].rejects(bound, test_threshold, n);
+            }
+        }
+    }
+    printf("threshold %u: %d gesture pairs above it, %d (%d%%) rejected by LB_Keogh, %d (%d%%) with the projection\n",
+        test_threshold, above, byKeogh, byKeogh * 100 / above, byBound, byBound * 100 / above);
+    check(wrong == 0);
+    check(byBound * 100 >= test_pruned * above);
+}
+
+int main(int argc, char **argv){
+    std::vector<Trace::Trace> traces = Recording::cutAll((argc > 1) ? argv[1] : ".", test_decimation, test_length, test_step);
+    int count = traces.size();
+    if(!check(count > 10)){
+        return Check::finish("test_envelope");
+    }
+    static Dtw::Dtw matcher(test_band);
+    static std::vector<Envelope::Envelope> envelopes(count);
+    static std::vector<Envelope::Envelope> widened(count);
+    Trace::Trace tolerance;
+    for(int i = 0; i < trace_length; i++){
+        tolerance.append(Trace::Point{test_tolerance, test_tolerance, test_tolerance});
+    }
+    for(int k = 0; k < count; k++){
+        envelopes[k].build(traces[k], NULL, test_band);
+        widened[k].build(traces[k], &tolerance, test_band);
+    }
+
+    //the bound never rules out the score
+    std::vector<unsigned int> scores(count * count);
+    std::vector<unsigned int> bounds(count * count);
+    std::vector<unsigned int> keoghs(count * count);
+    int above = 0;
+    int aboveTolerance = 0;
+    int covered = 0;
+    for(int p = 0; p < count; p++){
+        int n = traces[p].getSize();
+        for(int k = 0; k < count; k++){
+            matcher.setTolerance(NULL);
+            scores[p * count + k] = matcher.compare(traces[p], traces[k]);
+            bounds[p * count + k] = envelopes[k].lowerBound(traces[p]);
+            keoghs[p * count + k] = keogh(envelopes[k], traces[p]);
+            above += envelopes[k].rejects(bounds[p * count + k], scores[p * count + k], n);
+            covered += envelopes[k].covers(n);
+            matcher.setTolerance(&tolerance);
+            aboveTolerance += widened[k].rejects(widened[k].lowerBound(traces[p]), matcher.compare(traces[p], traces[k]), n);
+        }
+    }
+    matcher.setTolerance(NULL);
+    printf("pairs: %d  covered by the envelope: %d\n", count * count, covered);
+    check(above == 0);
+    check(aboveTolerance == 0);
+
+    //share of the pairs above each threshold rejected by the bound alone
+    const unsigned int thresholds[] = {500, 1000, 2000, test_threshold};
+    for(unsigned int threshold : thresholds){
+        int rejected = 0;
+        int byKeogh = 0;
+        int pruned = 0;
+        for(int i = 0; i < count * count; i++){
+            if(scores[i] > threshold){
+                int n = traces[i / count].getSize();
+                rejected++;
+                byKeogh += envelopes[i % count].rejects(keoghs[i], threshold, n);
+                pruned += envelopes[i % count].rejects(bounds[i], threshold, n);
+            }
+        }
+        printf("threshold %u: %d pairs above it, %d (%d%%) pruned by LB_Keogh, %d (%d%%) with the projection\n",
+            threshold, rejected, byKeogh, (rejected > 0) ? byKeogh * 100 / rejected : 0, pruned, (rejected > 0) ? pruned * 100 / rejected : 0);
+    }
+    testGestures((argc > 1) ? argv[1] : ".");
+
+    //cycles of the bound, of the alignment and of the cascade at the lowest threshold
+    unsigned int threshold = thresholds[1];
+    unsigned long long bound = ~0ULL;
+    unsigned long long alignment = ~0ULL;
+    unsigned long long cascade = ~0ULL;
+    unsigned long long sum = 0;
+    for(int run = 0; run < 5; run++){
+        unsigned long long start = Check::ticks();
+        for(int p = 0; p < count; p++){
+            for(int k = 0; k < count; k++){
+                sum += envelopes[k].lowerBound(traces[p]);
+            }
+        }
+        bound = std::min(bound, Check::ticks() - start);
+        start = Check::ticks();
+        for(int p = 0; p < count; p++){
+            for(int k = 0; k < count; k++){
+                sum += matcher.compare(traces[p], traces[k], threshold);
+            }
+        }
+        alignment = std::min(alignment, Check::ticks() - start);
+        start = Check::ticks();
+        for(int p = 0; p < count; p++){
+            for(int k = 0; k < count; k++){
+                //the projection pass only for the pairs LB_Keogh kept, as Keys::verify() does
+                int n = traces[p].getSize();
+                unsigned int bound = keogh(envelopes[k], traces[p]);
+                if(envelopes[k].rejects(bound, threshold, n)){
+                    continue;
+                }
+                bound += envelopes[k].projectionBound(traces[p]);
+                if(!envelopes[k].rejects(bound, threshold, n)){
+                    sum += matcher.compare(traces[p], traces[k], threshold);
+                }
+            }
+        }
+        cascade = std::min(cascade, Check::ticks() - start);
+    }
+    unsigned long long pairs = (unsigned long long)count * count;
+    printf("cycles per pair at threshold %u: bound %llu  dtw %llu  bound then dtw %llu (checksum %llu)\n",
+        threshold, bound / pairs, alignment / pairs, cascade / pairs, sum);
+    return Check::finish("test_envelope");
+}
@@ -0,0 +1,181 @@
+/*
+Feature test
+
+The recordings are played back the way recordGyro() sees them, brought up
+to 800Hz, filtered and cut into gestures by the segmenter. Each gesture is
+repeated the way a user would: a little faster or slower, a little stronger
+or weaker and with noise. Five repetitions are enrolled and three are held
+out as passwords. The key vector is the mean of the enrolled vectors, as
+Keys::enroll() builds it, and is compared with a key taken from the last
+repetition only. The feature stage must never reject a genuine password of
+the mean key at featureTolerance, and the share of the other gestures it
+rejects is measured, since it is a cheap first stage and not the decision.
+
+*/
+
+#include "feature.h"
+#include "segmenter.h"
+#include "dsp.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// feature test values
+#define test_rate_hz 800 // recording rate
+#define test_period 1250 // microseconds per sample at the recording rate
+#define test_cutoff 40 // noiseCutoff of main.cpp
+#define test_sensitivity 875 // hundredths of mdps per digit at 245dps
+#define test_tolerance 3428 // featureTolerance of main.cpp at 245dps
+#define test_enrolled 5 // repetitions merged into the key, enrollRepetitions of main.cpp
+#define test_held 3 // repetitions held out as passwords
+#define test_noise 400 // peak to peak noise added to a repetition, raw units
+
+unsigned int seed = 12345;
+
+int noise(){
+    seed = seed * 1103515245 + 12345;
+    return (int)((seed >> 16) % test_noise) - test_noise / 2;
+}
+
+short int rawRate(long mdps){
+    return (short int)(mdps * 100 / test_sensitivity);
+}
+
+short int clamp(double value){
+    return (short int)std::max(-32768.0, std::min(32767.0, value));
+}
+
+std::vector<std::vector<Gyro::Sample>> gestures(const std::vector<Recording::Line> &lines){
+    /*
+    Function used to play a recording through the filters and the segmenter
+    and keep the samples of each gesture in it.
+    Parameters:
+        lines: the lines of the recording
+    Returns:
+        the samples of each gesture
+    */
+    static Dsp::Median spikeFilter;
+    static Dsp::Biquad noiseFilter;
+    static Segmenter::Segmenter segmenter(segment_window_shift, segment_hold);
+    std::vector<std::vector<Gyro::Sample>> found(1);
+    spikeFilter.reset();
+    noiseFilter.setLowpass(test_rate_hz, test_cutoff);
+    noiseFilter.reset();
+    segmenter.reset();
+    segmenter.setThresholds(rawRate(onset_rate_mdps), rawRate(offset_rate_mdps));
+    for(Gyro::Sample sample : Recording::resample(lines, test_period)){
+        spikeFilter.apply(&sample);
+        noiseFilter.apply(&sample);
+        Segmenter::Event event = segmenter.add(sample);
+        if(segmenter.isActive()){
+            found.back().push_back(sample);
+        }
+        if(event == Segmenter::segment_done){
+            found.push_back(std::vector<Gyro::Sample>());
+            segmenter.reset();
+        }
+    }
+    found.pop_back(); // a gesture cut off by the end of the recording
+    return found;
+}
+
+Feature::Vector repeat(const std::vector<Gyro::Sample> &gesture, int number){
+    /*
+    Function used to make the feature vector of one repetition of a gesture:
+    resampled by a speed between 0.85 and 1.15, scaled by a gain between 0.9
+    and 1.1 and with noise added.
+    Parameters:
+        gesture: the samples of the gesture
+        number: repetition number, picks the speed and the gain
+    Returns:
+        the feature vector of the repetition
+    */
+    static Feature::Feature window(feature_window_shift);
+    double speed = 0.85 + 0.3 * ((number * 7) % 11) / 10.0;
+    double gain = 0.9 + 0.2 * ((number * 3) % 5) / 4.0;
+    window.reset();
+    int n = gesture.size();
+    for(double t = 0; t < n - 1; t += speed){
+        int i = (int)t;
+        double f = t - i;
+        const Gyro::Sample &a = gesture[i];
+        const Gyro::Sample &b = gesture[i + 1];
+        window.add(Gyro::Sample{clamp(gain * (a.x + (b.x - a.x) * f) + noise()), clamp(gain * (a.y + (b.y - a.y) * f) + noise()),
+            clamp(gain * (a.z + (b.z - a.z) * f) + noise()), 0, 0});
+    }
+    Feature::Vector vector;
+    window.finish(&vector);
+    return vector;
+}
+
+int main(int argc, char **argv){
+    std::vector<std::vector<Gyro::Sample>> all;
+    for(int r = 0; r < Recording::count; r++){
+        std::vector<std::vector<Gyro::Sample>> found = gestures(Recording::load((argc > 1) ? argv[1] : ".", Recording::names[r]));
+        all.insert(all.end(), found.begin(), found.end());
+    }
+    int count = all.size();
+    printf("gestures: %d\n", count);
+    if(!check(count > 10)){
+        return Check::finish("test_feature");
+    }
+
+    //the key of each gesture from every enrolled repetition and from the last one
+    std::vector<Feature::Vector> means(count);
+    std::vector<Feature::Vector> lasts(count);
+    std::vector<std::vector<Feature::Vector>> passwords(count);
+    for(int g = 0; g < count; g++){
+        Feature::Vector enrolled[test_enrolled];
+        for(int r = 0; r < test_enrolled; r++){
+            enrolled[r] = repeat(all[g], r);
+        }
+        for(int i = 0; i < feature_length; i++){
+            int total = 0;
+            for(int r = 0; r < test_enrolled; r++){
+                total += enrolled[r].values[i];
+            }
+            means[g].values[i] = (short int)(total / test_enrolled);
+        }
+        lasts[g] = enrolled[test_enrolled - 1];
+        for(int r = 0; r < test_held; r++){
+            passwords[g].push_back(repeat(all[g], test_enrolled + r));
+        }
+    }
+
+    //distances of the held out repetitions to each kind of key
+    const char *names[2] = {"last repetition", "mean of the repetitions"};
+    const std::vector<Feature::Vector> *kinds[2] = {&lasts, &means};
+    int genuineRejected[2] = {0, 0};
+    int impostorRejected[2] = {0, 0};
+    unsigned int genuineWorst[2] = {0, 0};
+    double genuineMean[2] = {0, 0};
+    int genuineCount = 0;
+    int impostorCount = 0;
+    for(int g = 0; g < count; g++){
+        for(int k = 0; k < count; k++){
+            for(const Feature::Vector &password : passwords[g]){
+                for(int kind = 0; kind < 2; kind++){
+                    unsigned int distance = password.distance((*kinds[kind])[k]);
+                    if(g == k){
+                        genuineRejected[kind] += (distance > test_tolerance);
+                        genuineWorst[kind] = std::max(genuineWorst[kind], distance);
+                        genuineMean[kind] += distance;
+                    }
+                    else{
+                        impostorRejected[kind] += (distance > test_tolerance);
+                    }
+                }
+                ((g == k) ? genuineCount : impostorCount)++;
+            }
+        }
+    }
+    for(int kind = 0; kind < 2; kind++){
+        printf("key from the %s: genuine distance mean %.0f, worst %u, %d of %d rejected; %d of %d others rejected (%d%%)\n",
+            names[kind], genuineMean[kind] / genuineCount, genuineWorst[kind], genuineRejected[kind], genuineCount,
+            impostorRejected[kind], impostorCount, 100 * impostorRejected[kind] / impostorCount);
+    }
+    check(genuineRejected[1] == 0);
+    check(genuineMean[1] <= genuineMean[0]);
+    return Check::finish("test_feature");
+}
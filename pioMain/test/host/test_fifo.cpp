@@ -0,0 +1,119 @@
+/*
+Fifo test
+
+The Gyro class drains the fifo of a fake gyro on the simulated SPI bus. The
+samples must come out oldest first, with the bias removed, consecutive
+numbers and times one output data period apart. A drain larger than the
+array leaves the rest for the next one, a fifo that filled up is counted as
+an overrun and read whole, and an empty fifo is not read at all.
+
+*/
+
+#include "gyro.h"
+#include "fakegyro.h"
+#include "check.h"
+
+// fifo test values
+#define test_period 1250 // microseconds between samples at 800Hz
+
+// x counts the samples, y counts down and z is offset, so a shifted or swapped byte shows
+void ramp(unsigned int number, short int *xyz){
+    xyz[0] = (short int)number;
+    xyz[1] = (short int)(-(int)number);
+    xyz[2] = (short int)(1000 + number);
+}
+
+bool consecutive(const Gyro::Sample *samples, int count, unsigned int first, short int bias){
+    /*
+    Function used to check drained samples against the ramp.
+    Parameters:
+        samples: the drained samples
+        count: number of samples
+        first: number of the first sample since power on
+        bias: bias removed from every axis
+    Returns:
+        true if every sample matches the ramp and follows the previous one
+    */
+    for(int i = 0; i < count; i++){
+        short int expected[3];
+        ramp(first + i, expected);
+        if((samples[i].x != expected[0] - bias) || (samples[i].y != expected[1] - bias) || (samples[i].z != expected[2] - bias)){
+            printf("sample %d: %d %d %d, expected sample %u\n", i, samples[i].x, samples[i].y, samples[i].z, first + i);
+            return false;
+        }
+        if((i > 0) && ((samples[i].sequence != samples[i - 1].sequence + 1) || (samples[i].time - samples[i - 1].time != test_period))){
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(){
+    FakeGyro::FakeGyro fake(PC_1, PA_1, PA_2);
+    Gyro::Gyro gyro(PF_9, PF_8, PF_7, PC_1, PA_2, PA_1);
+    fake.setSource(ramp);
+    Gyro::Sample samples[fifo_depth];
+
+    check(gyro.check_gyro());
+    check(gyro.setProfile(Gyro::odr_800hz, Gyro::bw_highest, Gyro::fs_245dps));
+
+    //a plain drain: every sample since the fifo was enabled, oldest first
+    gyro.enableFifo(0);
+    unsigned int first = fake.getProduced();
+    wait_us(10 * test_period + test_period / 2);
+    unsigned int transactions = fake.getTransactions();
+    int count = gyro.readFifo(samples, fifo_depth);
+    check(count == 10);
+    check(consecutive(samples, count, first, 0));
+    check(samples[count - 1].time <= us_ticker_read());
+    check(us_ticker_read() - samples[count - 1].time < test_period + 2000); //the burst takes about 1ms
+    check(fake.getTransactions() - transactions == 2); //fifo_src_reg then one burst
+    check(gyro.getX() == samples[count - 1].x);
+    first += count;
+
+    //an empty fifo is not read
+    transactions = fake.getTransactions();
+    check(gyro.readFifo(samples, fifo_depth) == 0);
+    check(fake.getTransactions() - transactions == 1);
+
+    //the bias is removed from every sample
+    gyro.setBias(7, 7, 7);
+    wait_us(4 * test_period);
+    count = gyro.readFifo(samples, fifo_depth);
+    check(count == 4);
+    check(consecutive(samples, count, first, 7));
+    first += count;
+    gyro.setBias(0, 0, 0);
+
+    //a drain larger than the array leaves the rest in the fifo
+    wait_us(20 * test_period);
+    count = gyro.readFifo(samples, 12);
+    check(count == 12);
+    check(consecutive(samples, count, first, 0));
+    first += count;
+    unsigned int sequence = samples[count - 1].sequence;
+    count = gyro.readFifo(samples, fifo_depth);
+    check(count >= 8);
+    check(consecutive(samples, count, first, 0));
+    check(samples[0].sequence == sequence + 1);
+    check(gyro.getFifoOverruns() == 0);
+
+    //a full fifo is counted as an overrun and read whole, the newest samples are kept
+    wait_us(50 * test_period);
+    unsigned int produced = fake.getProduced();
+    count = gyro.readFifo(samples, fifo_depth);
+    check(count == fifo_depth);
+    check(gyro.getFifoOverruns() == 1);
+    //samples that came in while the burst ran push the oldest out
+    check(consecutive(samples, count, (unsigned short int)samples[0].x, 0));
+    check((unsigned short int)samples[0].x >= produced - fifo_depth);
+    check((unsigned int)((unsigned short int)samples[0].x + count) <= fake.getProduced());
+
+    //bypass mode empties the fifo and stops filling it
+    gyro.disableFifo();
+    wait_us(10 * test_period);
+    check(fake.getLevel() == 0);
+
+    printf("samples produced: %u  transactions: %u  bytes: %u\n", fake.getProduced(), fake.getTransactions(), fake.getBytes());
+    return Check::finish("test_fifo");
+}
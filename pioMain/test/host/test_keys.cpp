@@ -0,0 +1,259 @@
+/*
+Keys test
+
+Checks how the moves, peak events and feature vector of a key are taken
+from the recordings it was enrolled from, with the Keys class placed in host memory instead of the SDRAM. A password
+the streaming match accepted on a prefix must still go through every stage
+of verify(), and only the listed slots are streamed to. Then the cycles of verify() are measured with 1 to 64 keys cut
+from the recordings. The cycles are those of the host, they only compare
+the number of keys with each other.
+
+*/
+
+#include "keys.h"
+#include "levenshtein.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// keys test values
+#define test_band 25 // band of main.cpp
+#define test_repetitions 5 // enrollRepetitions of main.cpp
+#define test_moves 40 // moves per recording
+#define test_decimation 4 // recording lines per point
+#define test_length 80 // points per trace, varied by a fifth
+#define test_step 20 // points between the starts of the traces
+#define test_threshold 5142 // 45000 mdps at 245dps, the threshold of main.cpp
+#define test_tolerance 150 // tolerance of every key point, raw units
+#define test_move_distance 2 // moveTolerance of main.cpp
+#define test_event_distance 8 // eventTolerance of main.cpp
+#define test_feature_distance 3428 // 30000 mdps at 245dps, featureTolerance of main.cpp
+#define test_max_slots 64 // most keys of the benchmark
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+static Keys::Keys keys(test_band);
+static Levenshtein::Levenshtein editor;
+
+void makeMoves(Moves::Moves *moves, unsigned int seed, int skip, int change){
+    /*
+    Function used to make a move sequence, the same for the same seed.
+    Parameters:
+        moves: the moves to fill
+        seed: picks the moves
+        skip: move left out, -1 for none
+        change: move changed, -1 for none
+    Returns:
+        None
+    */
+    moves->clear();
+    for(int i = 0; i < test_moves; i++){
+        seed = seed * 1103515245 + 12345;
+        char x = (seed >> 16) % 3;
+        char y = (seed >> 20) % 3;
+        char z = (seed >> 24) % 3;
+        if(i == skip){
+            continue;
+        }
+        if(i == change){
+            x = (x + 1) % 3;
+        }
+        moves->add(x, y, z);
+    }
+}
+
+void makePeaks(Peaks::Peaks *peaks, unsigned int seed, int skip){
+    /*
+    Function used to make a list of peak events, the same for the same seed.
+    Parameters:
+        peaks: the list to fill
+        seed: picks the axis, sign and height of each peak
+        skip: peak left out, -1 for none
+    Returns:
+        None
+    */
+    peaks->clear();
+    peaks->setThresholds(10000, 5000);
+    unsigned int time = 0;
+    for(int i = 0; i < 8; i++){
+        seed = seed * 1103515245 + 12345;
+        int axis = (seed >> 16) % 3;
+        short int rate = (short int)((((seed >> 20) & 1) ? -1 : 1) * (12000 + (int)((seed >> 21) % 16000)));
+        for(int k = 0; k < 100; k++){
+            short int values[3] = {0, 0, 0};
+            if((i != skip) && (k < 60)){
+                values[axis] = rate;
+            }
+            peaks->add(Gyro::Sample{values[0], values[1], values[2], time, 0});
+            time += 1250;
+        }
+    }
+    peaks->finish();
+}
+
+void testEnroll(){
+    //four good recordings of the same gesture, each off by a move, and a last one that went wrong
+    Moves::Moves recordings[test_repetitions];
+    Moves::Moves gesture;
+    makeMoves(&gesture, 7, -1, -1);
+    makeMoves(&recordings[0], 7, 3, -1);
+    makeMoves(&recordings[1], 7, -1, 10);
+    makeMoves(&recordings[2], 7, -1, -1);
+    makeMoves(&recordings[3], 7, 25, -1);
+    makeMoves(&recordings[4], 99, -1, -1);
+    //the same for the peak events, the last recording with other peaks
+    Peaks::Peaks events[test_repetitions];
+    Peaks::Peaks peaks;
+    makePeaks(&peaks, 7, -1);
+    makePeaks(&events[0], 7, 2);
+    makePeaks(&events[1], 7, -1);
+    makePeaks(&events[2], 7, 5);
+    makePeaks(&events[3], 7, 0);
+    makePeaks(&events[4], 99, -1);
+    check(peaks.getSize() == 8);
+    //feature vectors spread around a middle one
+    Feature::Vector vectors[test_repetitions];
+    for(int r = 0; r < test_repetitions; r++){
+        for(int i = 0; i < feature_length; i++){
+            vectors[r].values[i] = (short int)(300 * i - 10000 + 250 * r);
+        }
+    }
+
+    keys.getTrace(0)->append(Trace::Point{0, 0, 0});
+    keys.getTolerance(0)->append(Trace::Point{0, 0, 0});
+    keys.enroll(0, recordings, events, vectors, test_repetitions);
+    check(keys.isUsed(0));
+    check(editor.distance(*keys.getMoves(0), gesture, max_moves) == 0); //the recording closest to the others
+    check(editor.distance(*keys.getMoves(0), recordings[4], max_moves) > test_moves / 2);
+    check(keys.getPeaks(0)->distance(peaks, peak_gap_cost) == 0);
+    check(keys.getPeaks(0)->distance(events[4], peak_gap_cost) > peak_gap_cost);
+    check(keys.getFeatures(0)->distance(vectors[2]) == 0); //the mean of every recording
+
+    //a single recording is the key
+    keys.enroll(1, &recordings[1], &events[2], &vectors[3], 1);
+    check(editor.distance(*keys.getMoves(1), recordings[1], max_moves) == 0);
+    check(keys.getPeaks(1)->distance(events[2], peak_gap_cost) == 0);
+    check(keys.getFeatures(1)->distance(vectors[3]) == 0);
+    keys.erase(0);
+    keys.erase(1);
+}
+
+void makeKey(int slot, const Trace::Trace &trace, const Moves::Moves &gesture){
+    /*
+    Function used to put a key with the given trace and moves in a slot.
+    Parameters:
+        slot: slot of the key
+        trace: trace of the key
+        gesture: moves of the key
+    Returns:
+        None
+    */
+    *keys.getTrace(slot) = trace;
+    keys.getTolerance(slot)->clear();
+    for(int i = 0; i < trace.getSize(); i++){
+        keys.getTolerance(slot)->append(Trace::Point{test_tolerance, test_tolerance, test_tolerance});
+    }
+    static const Peaks::Peaks none;
+    static const Feature::Vector zero = {};
+    keys.enroll(slot, &gesture, &none, &zero, 1);
+}
+
+int verify(const Trace::Trace &trace, const Moves::Moves &attempt, unsigned int *score, const int *slots, int count){
+    /*
+    Function used to verify a password without peak events and features,
+    with the limits of main.cpp.
+    Parameters:
+        trace: the password trace
+        attempt: the password moves
+        score: pointer to the variable that will store the dtw score
+        slots: array of the slots to check, NULL for every used slot
+        count: number of slots in the array
+    Returns:
+        the matched slot, no_slot if none
+    */
+    static Peaks::Peaks events;
+    static Feature::Vector vector;
+    return keys.verify(trace, attempt, events, vector, test_threshold, test_move_distance, test_event_distance, test_feature_distance,
+        score, slots, count);
+}
+
+void testStreamedPrefix(const std::vector<Trace::Trace> &traces){
+    //the key is the start of a longer gesture, streaming accepts it before the password ends
+    const Trace::Trace &whole = traces[0];
+    Trace::Trace key;
+    for(int i = 0; i < whole.getSize() / 2; i++){
+        key.append(whole[i]);
+    }
+    Moves::Moves gesture;
+    Moves::Moves other;
+    makeMoves(&gesture, 7, -1, -1);
+    makeMoves(&other, 99, -1, -1);
+    makeKey(0, key, gesture);
+
+    keys.start(test_threshold);
+    int acceptedAt = -1;
+    for(int i = 0; (i < whole.getSize()) && (acceptedAt < 0); i++){
+        if(keys.push(whole[i]) == 0){
+            acceptedAt = i;
+        }
+    }
+    check((acceptedAt >= 0) && (acceptedAt < whole.getSize() - 1));
+    check(keys.getAccepted() == 0);
+
+    //a slot left out of the list is not streamed to
+    int slots[] = {0};
+    keys.start(test_threshold, slots, 0);
+    for(int i = 0; i < whole.getSize(); i++){
+        keys.push(whole[i]);
+    }
+    check(keys.getAccepted() == no_slot);
+    check(keys.getShortest() == key.getSize());
+
+    //the streamed slot is checked again and fails on its moves
+    unsigned int score;
+    check(verify(whole, other, &score, slots, 1) == no_slot);
+    check(score == dtw_no_match);
+    check(verify(key, other, &score, slots, 1) == no_slot);
+
+    //the same password with the moves of the key passes
+    check(verify(key, gesture, &score, slots, 1) == 0);
+    check(score <= test_threshold);
+    keys.erase(0);
+}
+
+void benchmarkSlots(const std::vector<Trace::Trace> &traces){
+    //keys with the moves of the password, so every key goes down to the trace stages
+    Moves::Moves gesture;
+    makeMoves(&gesture, 7, -1, -1);
+    int count = std::min((int)traces.size() - 1, test_max_slots);
+    const Trace::Trace &password = traces[0];
+    int used = 0;
+    for(int slots = 1; slots <= count; slots *= 2){
+        while(used < slots){
+            makeKey(used, traces[used + 1], gesture);
+            used++;
+        }
+        unsigned long long best = ~0ULL;
+        unsigned int score = 0;
+        int slot = no_slot;
+        for(int run = 0; run < test_runs; run++){
+            unsigned long long start = Check::ticks();
+            slot = verify(password, gesture, &score, NULL, 0);
+            best = std::min(best, Check::ticks() - start);
+        }
+        printf("%2d keys: %llu cycles per verify, %llu per key, matched slot %d score %u\n", slots, best, best / slots, slot, score);
+    }
+    for(int slot = 0; slot < used; slot++){
+        keys.erase(slot);
+    }
+}
+
+int main(int argc, char **argv){
+    testEnroll();
+    std::vector<Trace::Trace> traces = Recording::cutAll((argc > 1) ? argv[1] : ".", test_decimation, test_length, test_step);
+    if(check((int)traces.size() > test_max_slots)){
+        testStreamedPrefix(traces);
+        benchmarkSlots(traces);
+    }
+    return Check::finish("test_keys");
+}
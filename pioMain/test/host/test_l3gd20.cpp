@@ -0,0 +1,168 @@
+/*
+L3GD20 driver test and benchmark
+
+The BSP driver is built against a register file standing in for the
+sensor, which counts the SPI transactions and bytes it is asked for. Every
+raw value at every full scale and both endiannesses must convert to the
+same rate in the fixed point path as in the float path, exactly, the Q2
+rate being four times the float one. Then reading samples one at a time
+with L3GD20_ReadXYZAngRate(), which reads CTRL_REG4 back every time and
+converts in float, is compared with the fixed point read and the batch
+read of a full FIFO: the transactions and bytes per sample, the bus time
+they take at the 1MHz clock of the firmware, and the host cycles of the
+conversion. The cycles are those of the host, they only compare the paths
+with each other.
+
+*/
+
+#include "drivers/l3gd20.h"
+#include "check.h"
+#include <algorithm>
+
+// l3gd20 test values
+#define test_spi_hz 1000000 // SPI clock of the firmware
+#define test_samples 32000 // samples read per path
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+// register file of the sensor
+static uint8_t registers[0x40];
+static unsigned int transactions = 0;
+static unsigned int bytes = 0;
+static unsigned int sampleNumber = 0;
+
+void fillOutput(){
+    //the next sample in the output registers, in the order CTRL_REG4 sets
+    for(int axis = 0; axis < 3; axis++){
+        uint16_t value = (uint16_t)(sampleNumber * 7919 + axis * 104729);
+        bool big = (registers[L3GD20_CTRL_REG4_ADDR] & L3GD20_BLE_MSB) != 0;
+        registers[L3GD20_OUT_X_L_ADDR + 2 * axis] = big ? (uint8_t)(value >> 8) : (uint8_t)value;
+        registers[L3GD20_OUT_X_L_ADDR + 2 * axis + 1] = big ? (uint8_t)value : (uint8_t)(value >> 8);
+    }
+    sampleNumber++;
+}
+
+void GYRO_IO_Init(void){}
+
+void GYRO_IO_DeInit(void){}
+
+void GYRO_IO_Write(uint8_t *pBuffer, uint8_t WriteAddr, uint16_t NumByteToWrite){
+    transactions++;
+    bytes += 1 + NumByteToWrite;
+    for(int i = 0; i < NumByteToWrite; i++){
+        registers[(WriteAddr + i) & 0x3F] = pBuffer[i];
+    }
+}
+
+void GYRO_IO_Read(uint8_t *pBuffer, uint8_t ReadAddr, uint16_t NumByteToRead){
+    //the output registers wrap from OUT_Z_H back to OUT_X_L, each pass is a new FIFO sample
+    transactions++;
+    bytes += 1 + NumByteToRead;
+    for(int i = 0; i < NumByteToRead; i++){
+        if(ReadAddr == L3GD20_OUT_X_L_ADDR){
+            pBuffer[i] = registers[L3GD20_OUT_X_L_ADDR + i % 6];
+            if(i % 6 == 5){
+                fillOutput();
+            }
+        }
+        else{
+            pBuffer[i] = registers[(ReadAddr + i) & 0x3F];
+        }
+    }
+}
+
+void testExact(){
+    static const uint8_t scales[] = {L3GD20_FULLSCALE_250, L3GD20_FULLSCALE_500, L3GD20_FULLSCALE_2000};
+    int wrong = 0;
+    for(uint8_t scale : scales){
+        for(int big = 0; big < 2; big++){
+            L3GD20_Init((uint16_t)(((scale | (big ? L3GD20_BLE_MSB : 0)) << 8) | 0x0F));
+            for(int value = -32768; value <= 32767; value++){
+                uint8_t raw[6];
+                for(int axis = 0; axis < 3; axis++){
+                    uint16_t word = (uint16_t)(value + axis);
+                    raw[2 * axis] = big ? (uint8_t)(word >> 8) : (uint8_t)word;
+                    raw[2 * axis + 1] = big ? (uint8_t)word : (uint8_t)(word >> 8);
+                }
+                //the float path on the same bytes, through the output registers
+                for(int i = 0; i < 6; i++){
+                    registers[L3GD20_OUT_X_L_ADDR + i] = raw[i];
+                }
+                float rates[3];
+                L3GD20_ReadXYZAngRate(rates);
+                int32_t fixed[3];
+                L3GD20_ConvertAngRateBatch(raw, fixed, 1);
+                for(int axis = 0; axis < 3; axis++){
+                    wrong += ((float)fixed[axis] != rates[axis] * (1 << L3GD20_RATE_FRACTION_BITS));
+                }
+            }
+        }
+    }
+    check(wrong == 0);
+}
+
+void report(const char *name, unsigned long long cycles){
+    //bytes are clocked at the SPI rate, the address byte of each transaction included
+    printf("%s: %.2f transactions, %.1f bytes, %.1f us on the bus and %llu host cycles per sample\n", name,
+        (double)transactions / test_samples, (double)bytes / test_samples, (double)bytes * 8 * 1000000 / test_spi_hz / test_samples,
+        cycles / test_samples);
+}
+
+void benchmark(){
+    L3GD20_Init((uint16_t)((L3GD20_FULLSCALE_250 << 8) | 0x0F));
+    static float rates[L3GD20_FIFO_DEPTH * 3];
+    static int32_t fixed[L3GD20_FIFO_DEPTH * 3];
+    unsigned long long floatCycles = ~0ULL;
+    unsigned long long fixedCycles = ~0ULL;
+    unsigned long long batchCycles = ~0ULL;
+    unsigned int counts[3][2];
+    double sum = 0;
+    for(int run = 0; run < test_runs; run++){
+        transactions = bytes = 0;
+        unsigned long long start = Check::ticks();
+        for(int i = 0; i < test_samples; i++){
+            L3GD20_ReadXYZAngRate(rates);
+            sum += rates[0];
+        }
+        floatCycles = std::min(floatCycles, Check::ticks() - start);
+        counts[0][0] = transactions;
+        counts[0][1] = bytes;
+
+        transactions = bytes = 0;
+        start = Check::ticks();
+        for(int i = 0; i < test_samples; i++){
+            L3GD20_ReadXYZAngRateFixed(fixed);
+            sum += fixed[0];
+        }
+        fixedCycles = std::min(fixedCycles, Check::ticks() - start);
+        counts[1][0] = transactions;
+        counts[1][1] = bytes;
+
+        transactions = bytes = 0;
+        start = Check::ticks();
+        for(int i = 0; i < test_samples; i += L3GD20_FIFO_DEPTH){
+            L3GD20_ReadXYZAngRateBatch(fixed, L3GD20_FIFO_DEPTH);
+            sum += fixed[0];
+        }
+        batchCycles = std::min(batchCycles, Check::ticks() - start);
+        counts[2][0] = transactions;
+        counts[2][1] = bytes;
+    }
+    const char *names[3] = {"float, CTRL_REG4 read back", "fixed point, cached", "fixed point, batch of a full FIFO"};
+    unsigned long long cycles[3] = {floatCycles, fixedCycles, batchCycles};
+    for(int path = 0; path < 3; path++){
+        transactions = counts[path][0];
+        bytes = counts[path][1];
+        report(names[path], cycles[path]);
+    }
+    printf("(checksum %.0f)\n", sum);
+    check(counts[0][0] == 2 * test_samples); // CTRL_REG4 and the output registers
+    check(counts[1][0] == test_samples); // the output registers only
+    check(counts[2][0] == test_samples / L3GD20_FIFO_DEPTH);
+    check(counts[2][1] < counts[1][1]);
+}
+
+int main(){
+    testExact();
+    benchmark();
+    return Check::finish("test_l3gd20");
+}
@@ -0,0 +1,181 @@
+/*
+Levenshtein and moves test and benchmark
+
+The bit-parallel edit distance is checked against the plain dynamic
+programming one on random move sequences of every length around the 32
+move block boundaries, whole and one move at a time, with and without a
+largest distance of interest. The packed moves are checked to read back
+what was added and their bit distance against a count over the moves, and
+the bit distance plus the length difference never to be below the edit
+distance, since Keys::verify() skips the edit distance when it is within
+the limit. Then the cycles of both edit distances and of the bit distance
+are compared.
+
+*/
+
+#include "levenshtein.h"
+#include "moves.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+// levenshtein test values
+#define test_pairs 3000 // random pairs checked
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+unsigned int seed = 1;
+
+unsigned int next(){
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+void randomMoves(Moves::Moves *moves, int length, int symbols){
+    //symbols below 27 make matching moves likelier
+    moves->clear();
+    for(int i = 0; i < length; i++){
+        int s = next() % symbols;
+        moves->add(s % 3, (s / 3) % 3, s / 9);
+    }
+}
+
+void mutate(const Moves::Moves &from, Moves::Moves *to, int edits){
+    //the same moves with a few inserted, removed or changed
+    std::vector<char> moves;
+    for(int i = 0; i < from.getSize(); i++){
+        moves.push_back(from.getMove(i));
+    }
+    for(int e = 0; e < edits; e++){
+        int at = moves.empty() ? 0 : next() % moves.size();
+        int kind = next() % 3;
+        char move = (char)((next() % 3) | ((next() % 3) << 2) | ((next() % 3) << 4));
+        if((kind == 0) || moves.empty()){
+            moves.insert(moves.begin() + at, move);
+        }
+        else if(kind == 1){
+            moves.erase(moves.begin() + at);
+        }
+        else{
+            moves[at] = move;
+        }
+    }
+    to->clear();
+    for(size_t i = 0; i < moves.size() && i < max_moves; i++){
+        to->add(moves[i] & 3, (moves[i] >> 2) & 3, (moves[i] >> 4) & 3);
+    }
+}
+
+int reference(const Moves::Moves &key, const Moves::Moves &password, int prefix){
+    //edit distance of the key and the first prefix password moves, one full matrix column at a time
+    int m = key.getSize();
+    std::vector<int> column(m + 1), next(m + 1);
+    for(int i = 0; i <= m; i++){
+        column[i] = i;
+    }
+    for(int j = 1; j <= prefix; j++){
+        next[0] = j;
+        for(int i = 1; i <= m; i++){
+            int change = column[i - 1] + (key.getMove(i - 1) != password.getMove(j - 1));
+            next[i] = std::min(change, std::min(column[i] + 1, next[i - 1] + 1));
+        }
+        column.swap(next);
+    }
+    return column[m];
+}
+
+int main(){
+    static Levenshtein::Levenshtein editor;
+    Moves::Moves key, password;
+
+    //packed moves read back what was added, the bit distance counts the differing bits
+    bool packed = true;
+    bool bits = true;
+    for(int t = 0; t < 200; t++){
+        int length = next() % (max_moves + 1);
+        randomMoves(&key, length, 27);
+        randomMoves(&password, next() % (max_moves + 1), 27);
+        int differing = 0;
+        int longest = std::max(key.getSize(), password.getSize());
+        for(int i = 0; i < longest; i++){
+            char a = (i < key.getSize()) ? key.getMove(i) : 0;
+            char b = (i < password.getSize()) ? password.getMove(i) : 0;
+            differing += __builtin_popcount((a ^ b) & 0x3F);
+            packed = packed && ((a & 0x3F) == a) && ((b & 0x3F) == b);
+        }
+        bits = bits && (key.distance(password) == differing);
+    }
+    check(packed);
+    check(bits);
+    Moves::Moves full;
+    randomMoves(&full, max_moves, 27);
+    check(full.getSize() == max_moves);
+    check(!full.add(0, 0, 0)); //full sequences ignore new moves
+
+    //the edit distance of every length around the block boundaries
+    const int lengths[] = {0, 1, 2, 31, 32, 33, 63, 64, 65, 100, 127, 128, 129, 200, 255, 256};
+    int wrong = 0;
+    int wrongLimited = 0;
+    int wrongStreamed = 0;
+    int wrongBits = 0;
+    int withinBits = 0;
+    for(int t = 0; t < test_pairs; t++){
+        int m = lengths[next() % (sizeof(lengths) / sizeof(lengths[0]))];
+        randomMoves(&key, m, 2 + next() % 26);
+        if(t % 2){
+            mutate(key, &password, next() % 10);
+        }
+        else{
+            randomMoves(&password, lengths[next() % (sizeof(lengths) / sizeof(lengths[0]))], 2 + next() % 26);
+        }
+        int expected = reference(key, password, password.getSize());
+        wrong += (editor.distance(key, password, max_moves * 2) != expected);
+        int limit = next() % 12;
+        int limited = editor.distance(key, password, limit);
+        wrongLimited += (expected <= limit) ? (limited != expected) : (limited != limit + 1);
+        //a move that differs has a differing bit, the moves past the shorter sequence are removed
+        int bound = key.distance(password) + abs(key.getSize() - password.getSize());
+        wrongBits += (bound < expected);
+        withinBits += (bound <= 2); // moveTolerance of main.cpp
+        //the moves one at a time give the distance of every prefix
+        if(t % 10 == 0){
+            editor.start(key);
+            for(int j = 0; j < password.getSize(); j++){
+                wrongStreamed += (editor.push(password.getMove(j)) != reference(key, password, j + 1));
+            }
+        }
+    }
+    check(wrong == 0);
+    check(wrongLimited == 0);
+    check(wrongStreamed == 0);
+    check(wrongBits == 0);
+    printf("%d of %d pairs within the move tolerance by the bit distance alone\n", withinBits, test_pairs);
+
+    //cycles of the bit-parallel and the plain edit distance on full sequences
+    randomMoves(&key, max_moves, 27);
+    mutate(key, &password, 8);
+    unsigned long long parallel = ~0ULL;
+    unsigned long long plain = ~0ULL;
+    unsigned long long bitwise = ~0ULL;
+    long long sum = 0;
+    for(int run = 0; run < test_runs; run++){
+        unsigned long long start = Check::ticks();
+        for(int i = 0; i < 200; i++){
+            sum += editor.distance(key, password, max_moves * 2);
+        }
+        parallel = std::min(parallel, (Check::ticks() - start) / 200);
+        start = Check::ticks();
+        for(int i = 0; i < 20; i++){
+            sum += reference(key, password, password.getSize());
+        }
+        plain = std::min(plain, (Check::ticks() - start) / 20);
+        start = Check::ticks();
+        for(int i = 0; i < 200; i++){
+            sum += key.distance(password);
+        }
+        bitwise = std::min(bitwise, (Check::ticks() - start) / 200);
+    }
+    printf("%d by %d moves: bit-parallel %llu cycles, plain %llu cycles, %.1f times faster, bit distance %llu cycles (checksum %lld)\n",
+        key.getSize(), password.getSize(), parallel, plain, (double)plain / parallel, bitwise, sum);
+    return Check::finish("test_levenshtein");
+}
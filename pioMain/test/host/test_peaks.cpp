@@ -0,0 +1,98 @@
+/*
+Peaks test
+
+The recordings are played back the way recordGyro() sees them: the lines
+are brought up to 800Hz on a straight line between them, as recordHistory()
+does, then go through the spike and noise filters, and the segmenter cuts
+them into gestures. The peak detectors only run during a gesture. The events
+of every gesture are counted, no gesture may come within a quarter of the
+peak_max_events of a list, so a faster or longer gesture still fits, and
+the distance of the lists is checked to be symmetric and zero from a list
+to itself.
+
+*/
+
+#include "peaks.h"
+#include "segmenter.h"
+#include "dsp.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// peaks test values
+#define test_rate_hz 800 // recording rate
+#define test_period 1250 // microseconds per sample at the recording rate
+#define test_cutoff 40 // noiseCutoff of main.cpp
+#define test_sensitivity 875 // hundredths of mdps per digit at 245dps
+#define test_reset 5000 // reset_trigger_mdps at 245dps
+
+short int rawRate(long mdps){
+    return (short int)(mdps * 100 / test_sensitivity);
+}
+
+std::vector<Peaks::Peaks> gestures(const std::vector<Recording::Line> &lines){
+    /*
+    Function used to play a recording through the filters and the segmenter
+    and find the peak events of each gesture in it.
+    Parameters:
+        lines: the lines of the recording
+    Returns:
+        the events of each gesture
+    */
+    static Dsp::Median spikeFilter;
+    static Dsp::Biquad noiseFilter;
+    static Segmenter::Segmenter segmenter(segment_window_shift, segment_hold);
+    std::vector<Peaks::Peaks> found;
+    spikeFilter.reset();
+    noiseFilter.setLowpass(test_rate_hz, test_cutoff);
+    noiseFilter.reset();
+    segmenter.reset();
+    segmenter.setThresholds(rawRate(onset_rate_mdps), rawRate(offset_rate_mdps));
+    Peaks::Peaks peaks;
+    peaks.setThresholds(rawRate(peak_onset_mdps), test_reset);
+    for(Gyro::Sample sample : Recording::resample(lines, test_period)){
+        spikeFilter.apply(&sample);
+        noiseFilter.apply(&sample);
+        Segmenter::Event event = segmenter.add(sample);
+        if(segmenter.isActive()){
+            peaks.add(sample);
+        }
+        if(event == Segmenter::segment_done){
+            peaks.finish();
+            found.push_back(peaks);
+            peaks.clear();
+            segmenter.reset();
+        }
+    }
+    return found;
+}
+
+int main(int argc, char **argv){
+    const char *directory = (argc > 1) ? argv[1] : ".";
+    std::vector<Peaks::Peaks> all;
+    for(int r = 0; r < Recording::count; r++){
+        std::vector<Peaks::Peaks> found = gestures(Recording::load(directory, Recording::names[r]));
+        int most = 0;
+        int total = 0;
+        for(const Peaks::Peaks &peaks : found){
+            most = std::max(most, peaks.getSize());
+            total += peaks.getSize();
+        }
+        printf("%s: %d gestures, %d events, at most %d in a gesture\n", Recording::names[r], (int)found.size(), total, most);
+        check(found.size() > 0);
+        check(most <= peak_max_events * 3 / 4);
+        all.insert(all.end(), found.begin(), found.end());
+    }
+
+    //the distance is symmetric and zero from a list to itself
+    int wrong = 0;
+    for(size_t a = 0; a < all.size(); a++){
+        wrong += (all[a].distance(all[a], 2 * peak_max_events * peak_gap_cost) != 0);
+        for(size_t b = 0; b < all.size(); b++){
+            wrong += (all[a].distance(all[b], 2 * peak_max_events * peak_gap_cost) != all[b].distance(all[a], 2 * peak_max_events * peak_gap_cost));
+        }
+    }
+    check(wrong == 0);
+    return Check::finish("test_peaks");
+}
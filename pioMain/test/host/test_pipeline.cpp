@@ -0,0 +1,143 @@
+/*
+Pipeline test
+
+The comb decimator is checked bit for bit against cascaded moving sums in
+64 bits for every order up to cic_order_max and every factor up to 16.
+Then the pipeline is fed at the sensor rate for a few allowed factors: the
+matching and display streams must give one sample per matchFactor and per
+matchFactor * displayFactor sensor samples, with unit gain at DC, and a
+step must reach half its height in the matching stream where getDelay()
+says, since the recording trims the final pause by it. Factors that are not
+allowed must be refused. Last the cycles per sensor sample are measured,
+the cycles are those of the host.
+
+*/
+
+#include "pipeline.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// pipeline test values
+#define test_samples 4096 // sensor samples per check
+#define test_level 12000 // height of the dc and step inputs
+#define test_step_at 2000 // sensor sample where the step starts
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+unsigned int seed = 1;
+
+unsigned int next(){
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+Gyro::Sample makeSample(int x, int y, int z, int i){
+    return Gyro::Sample{(short int)x, (short int)y, (short int)z, (unsigned int)i * 1250, (unsigned int)i};
+}
+
+void testCic(){
+    //noisy full scale input, the same on each axis but scaled and negated
+    std::vector<long long> input(test_samples);
+    for(int i = 0; i < test_samples; i++){
+        input[i] = (short int)next();
+    }
+    static Dsp::Cic cic;
+    int wrong = 0;
+    for(int order = 1; order <= cic_order_max; order++){
+        for(int shift = 0; shift <= 4; shift++){
+            if(!check(cic.configure(order, shift))){
+                continue;
+            }
+            int factor = 1 << shift;
+            std::vector<long long> sums = input;
+            for(int stage = 0; stage < order; stage++){
+                std::vector<long long> summed(test_samples, 0);
+                for(int i = 0; i < test_samples; i++){
+                    for(int k = 0; (k < factor) && (k <= i); k++){
+                        summed[i] += sums[i - k];
+                    }
+                }
+                sums = summed;
+            }
+            for(int i = 0; i < test_samples; i++){
+                Gyro::Sample output;
+                bool given = cic.decimate(makeSample(input[i], -input[i], input[i] / 2, i), &output);
+                wrong += (given != ((i + 1) % factor == 0));
+                if(given){
+                    //the gain is factor to the order, a shift of order * shift
+                    wrong += (output.x != (short int)(sums[i] >> (order * shift)));
+                    wrong += (output.sequence != (unsigned int)i);
+                }
+            }
+        }
+    }
+    check(wrong == 0);
+}
+
+void testStreams(int matchFactor, int displayFactor){
+    static Pipeline::Pipeline pipeline;
+    check(pipeline.configure(matchFactor, displayFactor));
+    check((pipeline.getMatchFactor() == matchFactor) && (pipeline.getDisplayFactor() == displayFactor));
+
+    //rates and unit gain at dc
+    int matches = 0;
+    int displays = 0;
+    for(int i = 0; i < test_samples; i++){
+        int outputs = pipeline.add(makeSample(test_level, -test_level, 0, i));
+        matches += ((outputs & Pipeline::output_match) != 0);
+        displays += ((outputs & Pipeline::output_display) != 0);
+    }
+    check(matches == test_samples / matchFactor);
+    check(displays == test_samples / (matchFactor * displayFactor));
+    const Gyro::Sample &match = pipeline.getMatch();
+    const Gyro::Sample &display = pipeline.getDisplay();
+    check((abs(match.x - test_level) <= 8) && (abs(match.y + test_level) <= 8) && (match.z == 0));
+    check((abs(display.x - test_level) <= 8) && (abs(display.y + test_level) <= 8) && (display.z == 0));
+
+    //a step reaches half its height in the matching stream after the delay
+    pipeline.reset();
+    int half = -1;
+    for(int i = 0; (i < test_samples) && (half < 0); i++){
+        int level = (i >= test_step_at) ? test_level : 0;
+        if((pipeline.add(makeSample(level, level, level, i)) & Pipeline::output_match) && (pipeline.getMatch().x >= test_level / 2)){
+            half = pipeline.getMatch().sequence;
+        }
+    }
+    int delay = half - test_step_at;
+    printf("factors %d and %d: delay %d sensor samples, step at half height after %d\n", matchFactor, displayFactor, pipeline.getDelay(), delay);
+    check(abs(delay - pipeline.getDelay()) <= matchFactor);
+}
+
+void benchmark(){
+    static Pipeline::Pipeline pipeline;
+    pipeline.configure(16, 4);
+    std::vector<Gyro::Sample> samples(test_samples);
+    for(int i = 0; i < test_samples; i++){
+        samples[i] = makeSample((short int)next(), (short int)next(), (short int)next(), i);
+    }
+    unsigned long long fastest = ~0ULL;
+    unsigned long long sum = 0;
+    for(int run = 0; run < test_runs; run++){
+        pipeline.reset();
+        unsigned long long start = Check::ticks();
+        for(int i = 0; i < test_samples; i++){
+            sum += pipeline.add(samples[i]);
+        }
+        fastest = std::min(fastest, Check::ticks() - start);
+    }
+    printf("%llu cycles per sensor sample (checksum %llu)\n", fastest / test_samples, sum);
+}
+
+int main(){
+    testCic();
+    testStreams(16, 4); // the factors of main.cpp
+    testStreams(8, 2);
+    testStreams(32, 1);
+    static Pipeline::Pipeline pipeline;
+    check(!pipeline.configure(1, 4)); // the fir needs a factor of at least 2
+    check(!pipeline.configure(12, 4)); // not a power of two
+    check(!pipeline.configure(16, 3));
+    check(pipeline.getMatchFactor() == 16); // a refused factor keeps the last streams
+    benchmark();
+    return Check::finish("test_pipeline");
+}
@@ -0,0 +1,110 @@
+/*
+Recording test
+
+main.cpp is built on the host, its main() renamed, against the LCD stub and
+with the SDRAM mapped at its address for the keys. The acquisition thread
+does not run on the host, so its loop is played by an event every sensor
+period: a sample of the recordings, brought up to 800Hz, is pushed into the
+sample ring and the recording is woken once wakeSamples are waiting, like
+acquireGyro() does. Its own cost is not counted, nor the drawing on the LCD.
+
+The code run between two waits takes test_slowdown times its host time on
+the simulated clock, a Cortex-M4 at 180MHz being taken as that much slower
+than the host, and the rest of the time the core sleeps in a wait. A key is
+enrolled with enrollKey() and a password recorded and checked, and the
+busy share printStats() keeps for every recordGyro() must be a few percent,
+with no sample lost.
+
+*/
+
+#include <sys/mman.h>
+#include "lcd.h"
+#include "fakegyro.h"
+#include "recording.h"
+#include "check.h"
+
+// the SDRAM of the board at its address, mapped before main.cpp places the keys in it
+static void *sdram = mmap((void *)SDRAM_DEVICE_ADDR, SDRAM_DEVICE_SIZE, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+#define main firmwareMain
+#include "main.cpp"
+#undef main
+
+// recording test values
+#define test_period 1250 // microseconds per sample at 800Hz
+#define test_slowdown 40 // time the core takes for each unit of host time
+#define test_busy 5 // highest busy share of a recording, in percent
+
+static std::vector<Gyro::Sample> played;
+static unsigned int playedNumber = 0;
+
+void acquire(){
+    /*
+    Function used to play one pass of the acquisition thread loop: the next
+    sample is stamped with the simulated time and pushed into the sample
+    ring, then the next pass is scheduled a sensor period later.
+    Parameters:
+        None
+    Returns:
+        None
+    */
+    Gyro::Sample sample = played[playedNumber % played.size()];
+    sample.time = us_ticker_read();
+    sample.sequence = playedNumber++;
+    sampleRing.push(sample);
+    if(sampleRing.size() >= wakeSamples){
+        events.set(samplesFlag);
+    }
+    Host::schedule(Host::now() + test_period, acquire);
+}
+
+void expectStats(const char *name){
+    //the busy share in tenths of a percent too, from the start of the recording kept by recordGyro()
+    mbed_stats_cpu_t cpuEnd;
+    mbed_stats_cpu_get(&cpuEnd);
+    uint64_t uptime = cpuEnd.uptime - cpuStart.uptime;
+    uint64_t busy = uptime - (cpuEnd.idle_time - cpuStart.idle_time);
+    printf("%s: %u samples, %u lost, cpu busy %u%% (%.1f%%)\n", name, recordingStats.samples,
+        recordingStats.lastSequence - recordingStats.firstSequence + 1 - recordingStats.samples, recordingStats.cpuBusy,
+        100.0 * busy / uptime);
+    check(busy > 0); // the code took time
+    check(recordingStats.samples > 0);
+    check(recordingStats.lastSequence - recordingStats.firstSequence + 1 == recordingStats.samples);
+    check(sampleRing.getOverruns() == 0);
+    check(recordingStats.cpuBusy <= test_busy);
+}
+
+int main(int argc, char **argv){
+    if(!check(sdram == (void *)SDRAM_DEVICE_ADDR)){
+        return Check::finish("test_record");
+    }
+    played = Recording::resample(Recording::load((argc > 1) ? argv[1] : ".", Recording::names[0]), test_period);
+    if(!check(played.size() > 0)){
+        return Check::finish("test_record");
+    }
+
+    //the start of main() of the firmware, with the acquisition thread played by events
+    FakeGyro::FakeGyro fake(chip_select, motion, data_ready);
+    Host::attach(chip_select, &fake);
+    gyro.init();
+    gyro.setProfile(idleProfile);
+    pipeline.configure(trace_decimation, displayFactor);
+    Host::schedule(Host::now() + test_period, acquire);
+    Host::setSlowdown(test_slowdown);
+
+    //every recording of the key
+    for(int i = 0; i < enrollRepetitions; i++){
+        recordGyro(&keyMoves[i], &keyPeaks[i], &keyFeatures[i], &keyRecordings[i], NULL, false, false);
+        expectStats("key recording");
+    }
+    averager.average(keyRecordings, enrollRepetitions, keys->getTrace(0), keys->getTolerance(0));
+    keys->enroll(0, keyMoves, keyPeaks, keyFeatures, enrollRepetitions);
+    keyIndex->insert(0, *keys->getTrace(0));
+
+    //a password streamed to the key and checked
+    recordGyro(&passwordMoves, &passwordPeaks, &passwordFeatures, &passwordTrace, keys, true, false);
+    expectStats("password");
+    checkPassword();
+    return Check::finish("test_record");
+}
@@ -0,0 +1,102 @@
+/*
+Ring stress test
+
+One thread pushes numbered items as fast as it can while another pops them
+in batches, pausing now and then so the ring fills up and overruns. The
+consumer must see the items it was given in the order they were pushed, each
+one whole, and every push the producer saw fail must be counted as an
+overrun.
+
+*/
+
+#include "ring.h"
+#include "check.h"
+#include <thread>
+#include <atomic>
+
+// ring test values
+#define test_items 20000000 // items pushed
+#define test_capacity 256 // items in the ring, the size main.cpp uses
+#define test_batch 32 // items popped at once
+#define test_pause_every 4096 // pops between pauses of the consumer
+#define test_pace 64 // pushes between busy waits of the producer
+#define test_pace_spins 2000 // length of a busy wait
+
+// item with a payload that tells if it was torn
+struct Item{
+    unsigned int sequence;
+    unsigned int inverse; // ~sequence
+    unsigned int square; // sequence * sequence
+};
+
+Ring::Ring<Item, test_capacity> ring;
+
+void produce(std::atomic<unsigned int> *dropped){
+    /*
+    Function run by the producer thread.
+    Parameters:
+        dropped: pointer to the number of pushes that failed
+    Returns:
+        None
+    */
+    for(unsigned int i = 0; i < test_items; i++){
+        Item item = {i, ~i, i * i};
+        if(!ring.push(item)){
+            dropped->fetch_add(1, std::memory_order_relaxed);
+        }
+        //slow down now and then so the consumer catches up and the ring also runs nearly empty
+        if((i % test_pace) == 0){
+            for(volatile int spin = 0; spin < test_pace_spins; spin = spin + 1){}
+        }
+    }
+}
+
+int main(){
+    std::atomic<unsigned int> dropped(0);
+    unsigned int received = 0;
+    unsigned int torn = 0;
+    unsigned int reordered = 0;
+    unsigned int oversized = 0;
+    unsigned int empty = 0; // pops that found the ring empty
+    long long last = -1;
+    Item batch[test_batch];
+
+    std::thread producer(produce, &dropped);
+    int pops = 0;
+    while(received + dropped < test_items){
+        int count = ring.pop(batch, test_batch);
+        if(count > test_batch){
+            oversized++;
+        }
+        if(count == 0){
+            empty++;
+        }
+        for(int i = 0; i < count; i++){
+            const Item &item = batch[i];
+            if((item.inverse != ~item.sequence) || (item.square != item.sequence * item.sequence)){
+                torn++;
+            }
+            if((long long)item.sequence <= last){
+                reordered++;
+            }
+            last = item.sequence;
+        }
+        received += count;
+        if((++pops % test_pause_every) == 0){
+            std::this_thread::sleep_for(std::chrono::microseconds(50)); // let the ring fill up
+        }
+    }
+    producer.join();
+
+    printf("received: %u  dropped: %u  overruns: %u  empty pops: %u  high watermark: %u/%u\n",
+        received, dropped.load(), ring.getOverruns(), empty, ring.getHighWatermark(), ring.getCapacity());
+    check(torn == 0);
+    check(reordered == 0);
+    check(oversized == 0);
+    check(received + dropped == test_items);
+    check(ring.getOverruns() == dropped);
+    check(ring.getHighWatermark() <= test_capacity);
+    check(ring.size() == 0);
+    check((empty > 0) && (dropped > 0)); // both the empty and the full ring were hit
+    return Check::finish("test_ring");
+}
@@ -0,0 +1,140 @@
+/*
+Sax test and evaluation
+
+On traces cut from the recordings, each one a key with a tolerance and a
+password of every other, the MINDIST of the password word and of the word
+of the key envelope is checked never to go above the LB_Keogh bound of the
+envelope, nor that bound above the dtw score. For a few thresholds the
+share of the pairs above the threshold that each bound rejects is
+measured and must reach the share the words were seen to reject, with none
+at the match threshold, then the bytes of each part of a key, with the
+cycles of the word bound, of the envelope bound and of the alignment. The
+cycles are those of the host, they only compare the stages with each other.
+
+*/
+
+#include "sax.h"
+#include "envelope.h"
+#include "dtw.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// sax test values
+#define test_decimation 4 // recording lines per point
+#define test_length 80 // points per trace, varied by a fifth
+#define test_step 20 // points between the starts of the traces
+#define test_band 25 // band of main.cpp
+#define test_tolerance 150 // tolerance of every key point, raw units
+#define test_alphabet 16 // symbols per axis, a nibble either way
+#define test_scale 16000 // sax_scale_mdps at 245dps
+#define test_runs 5 // benchmark runs, the fastest is kept
+#define test_match 5142 // 45000 mdps at 245dps, matchThreshold of main.cpp
+
+int main(int argc, char **argv){
+    std::vector<Trace::Trace> traces = Recording::cutAll((argc > 1) ? argv[1] : ".", test_decimation, test_length, test_step);
+    int count = traces.size();
+    if(!check(count > 10)){
+        return Check::finish("test_sax");
+    }
+    static Dtw::Dtw matcher(test_band);
+    static Sax::Sax sax(test_alphabet, test_scale);
+    static Envelope::Envelope envelope;
+    static Trace::Trace tolerance;
+    for(int i = 0; i < trace_length; i++){
+        tolerance.append(Trace::Point{test_tolerance, test_tolerance, test_tolerance});
+    }
+    matcher.setTolerance(&tolerance);
+    std::vector<Sax::Word> keyWords(count);
+    std::vector<Sax::Word> words(count);
+    for(int k = 0; k < count; k++){
+        envelope.build(traces[k], &tolerance, test_band);
+        sax.encode(envelope, &keyWords[k]);
+        sax.encode(traces[k], &words[k]);
+    }
+
+    //MINDIST <= LB_Keogh <= dtw on every pair the envelope covers
+    std::vector<unsigned int> scores(count * count);
+    std::vector<unsigned int> wordBounds(count * count);
+    std::vector<unsigned int> envelopeBounds(count * count);
+    int covered = 0;
+    int wordAbove = 0;
+    int envelopeAbove = 0;
+    for(int k = 0; k < count; k++){
+        envelope.build(traces[k], &tolerance, test_band);
+        for(int p = 0; p < count; p++){
+            int i = p * count + k;
+            int n = traces[p].getSize();
+            scores[i] = matcher.compare(traces[p], traces[k]);
+            wordBounds[i] = 0;
+            envelopeBounds[i] = 0;
+            if(envelope.covers(n)){
+                covered++;
+                wordBounds[i] = sax.minDist(words[p], keyWords[k]) / (unsigned int)(n + traces[k].getSize());
+                envelopeBounds[i] = envelope.lowerBound(traces[p]) / (unsigned int)(n + traces[k].getSize());
+                wordAbove += (wordBounds[i] > envelopeBounds[i]);
+                envelopeAbove += (envelopeBounds[i] > scores[i]);
+            }
+        }
+    }
+    printf("pairs: %d  covered by the envelope: %d\n", count * count, covered);
+    check(wordAbove == 0);
+    check(envelopeAbove == 0);
+
+    //share of the pairs above a threshold each bound rejects, and the least share in percent the words must reject
+    static const unsigned int thresholds[][2] = {{250, 35}, {500, 20}, {1000, 4}, {2000, 0}, {test_match, 0}};
+    for(const unsigned int *row : thresholds){
+        unsigned int threshold = row[0];
+        int above = 0;
+        int byWord = 0;
+        int byEnvelope = 0;
+        for(int i = 0; i < count * count; i++){
+            if(scores[i] > threshold){
+                above++;
+                byWord += (wordBounds[i] > threshold);
+                byEnvelope += (envelopeBounds[i] > threshold);
+            }
+        }
+        printf("threshold %u: %d pairs above it, %d (%d%%) rejected by the words, %d (%d%%) by the envelopes\n", threshold, above,
+            byWord, above ? 100 * byWord / above : 0, byEnvelope, above ? 100 * byEnvelope / above : 0);
+        check(above > 0);
+        check((unsigned int)byWord * 100 >= row[1] * above);
+        if(threshold == test_match){
+            check(byWord == 0); // no pruning at the match threshold, verify() leaves the words out
+        }
+    }
+
+    //bytes per key
+    printf("bytes per key: word %d, template %d, envelope %d, the word is %.1f times smaller than the template\n",
+        (int)sizeof(Sax::Word), (int)sizeof(Trace::Trace), (int)sizeof(Envelope::Envelope), (double)sizeof(Trace::Trace) / sizeof(Sax::Word));
+
+    //cycles of each stage
+    unsigned long long wordCycles = ~0ULL;
+    unsigned long long boundCycles = ~0ULL;
+    unsigned long long alignmentCycles = ~0ULL;
+    unsigned long long sum = 0;
+    for(int run = 0; run < test_runs; run++){
+        unsigned long long start = Check::ticks();
+        for(int k = 0; k < count; k++){
+            for(int p = 0; p < count; p++){
+                sum += sax.minDist(words[p], keyWords[k]);
+            }
+        }
+        wordCycles = std::min(wordCycles, Check::ticks() - start);
+        envelope.build(traces[0], &tolerance, test_band);
+        start = Check::ticks();
+        for(int p = 0; p < count; p++){
+            sum += envelope.lowerBound(traces[p]);
+        }
+        boundCycles = std::min(boundCycles, Check::ticks() - start);
+        start = Check::ticks();
+        for(int p = 0; p < count; p++){
+            sum += matcher.compare(traces[p], traces[0]);
+        }
+        alignmentCycles = std::min(alignmentCycles, Check::ticks() - start);
+    }
+    printf("cycles per pair: word bound %llu, envelope bound %llu, dtw %llu (checksum %llu)\n",
+        wordCycles / ((unsigned long long)count * count), boundCycles / count, alignmentCycles / count, sum);
+    return Check::finish("test_sax");
+}
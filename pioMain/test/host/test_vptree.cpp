@@ -0,0 +1,254 @@
+/*
+Vptree test and benchmark
+
+Keys are cut from the recordings every few points and inserted in the
+index, then the keys it finds closest to a trace are checked against a
+plain ranking of every key by the edit distance with real penalty, also
+after keys were removed and inserted again. Passwords are cut from the same
+recordings at a fifth more speed, the key cut from the same lines is the
+genuine key of each and has the lowest dtw score. The rank the index gives
+the genuine key is measured, to see how often the matchCandidates closest
+signatures miss it, and the search of checkPassword() that doubles the keys
+taken until one matches must always reach it. Then the cycles of a search
+are compared with ranking every key. The cycles are those of the host, they
+only compare the two with each other.
+
+*/
+
+#include "vptree.h"
+#include "dtw.h"
+#include "recording.h"
+#include "check.h"
+#include <vector>
+#include <algorithm>
+
+// vptree test values
+#define test_decimation 4 // recording lines per key point
+#define test_fast_decimation 5 // recording lines per password point, a fifth faster
+#define test_length 80 // points per key
+#define test_step 4 // points between the starts of the keys
+#define test_band 25 // band of main.cpp
+#define test_threshold 5142 // 45000 mdps at 245dps, the threshold of main.cpp
+#define test_candidates 3 // matchCandidates of main.cpp
+#define test_runs 5 // benchmark runs, the fastest is kept
+
+static Vptree::Vptree tree;
+
+void sign(const Trace::Trace &trace, Trace::Point *signature){
+    /*
+    Function used to reduce a trace to its signature, as the index does.
+    Parameters:
+        trace: the trace
+        signature: array that will store the signature_length points
+    Returns:
+        None
+    */
+    int n = trace.getSize();
+    for(int k = 0; k < signature_length; k++){
+        int low = k * n / signature_length;
+        int high = std::max((k + 1) * n / signature_length, low + 1);
+        int sum[3] = {0, 0, 0};
+        for(int i = low; (i < high) && (i < n); i++){
+            sum[0] += trace[i].x;
+            sum[1] += trace[i].y;
+            sum[2] += trace[i].z;
+        }
+        signature[k] = Trace::Point{(short int)(sum[0] / (high - low)), (short int)(sum[1] / (high - low)), (short int)(sum[2] / (high - low))};
+    }
+}
+
+unsigned int reference(const Trace::Point *a, const Trace::Point *b){
+    /*
+    Function used to find the edit distance with real penalty over the whole
+    cost matrix.
+    Parameters:
+        a, b: the signatures
+    Returns:
+        the distance
+    */
+    static const Trace::Point zero = {0, 0, 0};
+    std::vector<std::vector<unsigned int>> cost(signature_length + 1, std::vector<unsigned int>(signature_length + 1, 0));
+    for(int i = 1; i <= signature_length; i++){
+        cost[i][0] = cost[i - 1][0] + Dtw::pointCost(a[i - 1], zero);
+        cost[0][i] = cost[0][i - 1] + Dtw::pointCost(b[i - 1], zero);
+    }
+    for(int i = 1; i <= signature_length; i++){
+        for(int j = 1; j <= signature_length; j++){
+            cost[i][j] = std::min(cost[i - 1][j - 1] + Dtw::pointCost(a[i - 1], b[j - 1]),
+                std::min(cost[i - 1][j] + Dtw::pointCost(a[i - 1], zero), cost[i][j - 1] + Dtw::pointCost(b[j - 1], zero)));
+        }
+    }
+    return cost[signature_length][signature_length];
+}
+
+std::vector<unsigned int> ranking(const std::vector<Trace::Trace> &keys, const std::vector<bool> &inserted, const Trace::Trace &trace){
+    /*
+    Function used to rank the inserted keys by their distance to a trace.
+    Parameters:
+        keys: the key traces
+        inserted: which keys are in the index
+        trace: the trace
+    Returns:
+        the distances of the inserted keys, closest first
+    */
+    Trace::Point query[signature_length];
+    Trace::Point signature[signature_length];
+    sign(trace, query);
+    std::vector<unsigned int> distances;
+    for(size_t k = 0; k < keys.size(); k++){
+        if(inserted[k]){
+            sign(keys[k], signature);
+            distances.push_back(reference(query, signature));
+        }
+    }
+    std::sort(distances.begin(), distances.end());
+    return distances;
+}
+
+int checkNearest(const std::vector<Trace::Trace> &keys, const std::vector<bool> &inserted, const std::vector<Trace::Trace> &passwords){
+    /*
+    Function used to check the keys found by the index against the ranking.
+    Parameters:
+        keys: the key traces
+        inserted: which keys are in the index
+        passwords: the traces searched
+    Returns:
+        number of searches that did not find the closest keys
+    */
+    static int slots[vptree_capacity];
+    static unsigned int distances[vptree_capacity];
+    static const int counts[] = {1, test_candidates, 12};
+    int wrong = 0;
+    for(size_t p = 0; p < passwords.size(); p += 3){
+        std::vector<unsigned int> expected = ranking(keys, inserted, passwords[p]);
+        for(int count : counts){
+            int found = tree.nearest(passwords[p], count, slots, distances);
+            bool same = (found == std::min(count, (int)expected.size()));
+            for(int i = 0; same && (i < found); i++){
+                //keys at the same distance may come in any order, the distances may not
+                same = (distances[i] == expected[i]) && inserted[slots[i]];
+            }
+            wrong += !same;
+        }
+    }
+    return wrong;
+}
+
+int main(int argc, char **argv){
+    const char *directory = (argc > 1) ? argv[1] : ".";
+    std::vector<Trace::Trace> keys;
+    std::vector<Trace::Trace> passwords;
+    std::vector<int> sources; // key cut from the same lines as each password
+    for(int r = 0; r < Recording::count; r++){
+        std::vector<Recording::Line> lines = Recording::load(directory, Recording::names[r]);
+        std::vector<Trace::Trace> cut = Recording::cut(lines, test_decimation, test_length, test_step);
+        //a password every fifth key starts on the same line as the key
+        std::vector<Trace::Trace> fast = Recording::cut(lines, test_fast_decimation, test_length * test_decimation / test_fast_decimation,
+            test_step * 5 * test_decimation / test_fast_decimation);
+        for(size_t p = 0; (p < fast.size()) && (5 * p < cut.size()); p++){
+            passwords.push_back(fast[p]);
+            sources.push_back(keys.size() + 5 * p);
+        }
+        keys.insert(keys.end(), cut.begin(), cut.end());
+    }
+    if((int)keys.size() > vptree_capacity){
+        keys.resize(vptree_capacity);
+    }
+    int count = keys.size();
+    printf("keys: %d  passwords: %d\n", count, (int)passwords.size());
+    if(!check((count > 64) && (passwords.size() > 10))){
+        return Check::finish("test_vptree");
+    }
+
+    //every key inserted one by one, then a third removed and put back
+    std::vector<bool> inserted(count, false);
+    for(int k = 0; k < count; k++){
+        tree.insert(k, keys[k]);
+        inserted[k] = true;
+    }
+    check(tree.getSize() == count);
+    check(checkNearest(keys, inserted, passwords) == 0);
+    for(int k = 0; k < count; k += 3){
+        tree.remove(k);
+        inserted[k] = false;
+    }
+    check(tree.getSize() == count - (count + 2) / 3);
+    check(checkNearest(keys, inserted, passwords) == 0);
+    for(int k = 0; k < count; k += 3){
+        tree.insert(k, keys[k]);
+        inserted[k] = true;
+    }
+    check(tree.getSize() == count);
+    check(checkNearest(keys, inserted, passwords) == 0);
+    printf("depth: %d\n", tree.getDepth());
+
+    //the key of the same lines is the genuine key of each password, the one verify() accepts
+    static Dtw::Dtw matcher(test_band);
+    static int slots[vptree_capacity];
+    static unsigned int distances[vptree_capacity];
+    int closest = 0; // passwords whose genuine key has the lowest dtw score
+    int beyond = 0; // genuine key ranked beyond test_candidates by the index
+    int worst = 0; // furthest rank of a genuine key
+    int notFound = 0; // the doubling search did not reach the genuine key
+    long long taken = 0; // keys checked by the doubling search
+    for(size_t p = 0; p < passwords.size(); p++){
+        unsigned int genuine = matcher.compare(passwords[p], keys[sources[p]]);
+        bool lowest = (genuine <= test_threshold);
+        for(int k = 0; lowest && (k < count); k++){
+            lowest = (matcher.compare(passwords[p], keys[k]) >= genuine);
+        }
+        closest += lowest;
+        int found = tree.nearest(passwords[p], count, slots, distances);
+        for(int i = 0; i < found; i++){
+            if(slots[i] == sources[p]){
+                beyond += (i >= test_candidates);
+                worst = std::max(worst, i);
+            }
+        }
+
+        //the rounds of checkPassword()
+        std::vector<bool> checked(count, false);
+        bool matched = false;
+        for(int limit = test_candidates; !matched; limit = std::min(2 * limit, vptree_capacity)){
+            int round = tree.nearest(passwords[p], limit, slots, distances);
+            for(int i = 0; i < round; i++){
+                if(!checked[slots[i]]){
+                    checked[slots[i]] = true;
+                    taken++;
+                    matched = matched || (slots[i] == sources[p]);
+                }
+            }
+            if((round < limit) || (limit >= vptree_capacity)){
+                break;
+            }
+        }
+        notFound += !matched;
+    }
+    int total = passwords.size();
+    printf("genuine key with the lowest dtw score: %d of %d, ranked beyond the closest %d: %d, furthest rank %d\n",
+        closest, total, test_candidates, beyond, worst);
+    printf("doubling search: %.1f keys checked per password of %d\n", (double)taken / total, count);
+    check(closest == total);
+    check(notFound == 0);
+
+    //cycles of a search against ranking every key
+    unsigned long long searched = ~0ULL;
+    unsigned long long ranked = ~0ULL;
+    unsigned long long sum = 0;
+    for(int run = 0; run < test_runs; run++){
+        sum = 0;
+        unsigned long long start = Check::ticks();
+        for(size_t p = 0; p < passwords.size(); p++){
+            sum += tree.nearest(passwords[p], test_candidates, slots, distances);
+        }
+        searched = std::min(searched, Check::ticks() - start);
+        start = Check::ticks();
+        for(size_t p = 0; p < passwords.size(); p++){
+            sum += ranking(keys, inserted, passwords[p])[0];
+        }
+        ranked = std::min(ranked, Check::ticks() - start);
+    }
+    printf("%d keys: %llu cycles per search of %d, %llu ranking every key (checksum %llu)\n", count, searched / passwords.size(),
+        test_candidates, ranked / passwords.size(), sum);
+    return Check::finish("test_vptree");
+}